@@ -0,0 +1,74 @@
+#include "dvd_angle.h"
+
+/**
+ * Functions used to find the sectors of one angle in a multi-angle track
+ */
+
+int dvd_angle_extents(dvd_file_t *dvdread_vts_file, uint64_t first_sector, uint64_t last_sector, struct dvd_extents *dvd_extents, struct dvd_extents *bad_sectors) {
+
+	unsigned char buffer[DVD_VIDEO_LB_LEN];
+	dsi_t dsi;
+	uint64_t sector = first_sector;
+	uint64_t unit_last_sector = 0;
+	uint64_t next_sector = 0;
+	uint32_t next_address = 0;
+
+	while(sector < last_sector + 1) {
+
+		if(DVDReadBlocks(dvdread_vts_file, (int)sector, 1, buffer) != 1) {
+			if(!dvd_extents_add(bad_sectors, sector, sector))
+				return -1;
+			break;
+		}
+
+		if(!dvd_scan_nav_sector(buffer))
+			break;
+
+		navRead_DSI(&dsi, &buffer[DSI_START_BYTE]);
+
+		if(dsi.sml_pbi.category & DVD_ANGLE_ILVU) {
+
+			// A whole interleaved unit, and then on to the next one
+			unit_last_sector = sector + dsi.sml_pbi.ilvu_ea;
+			next_address = dsi.sml_pbi.ilvu_sa;
+
+		} else {
+
+			// One VOBU, with the next one of the same angle after it
+			unit_last_sector = sector + dsi.dsi_gi.vobu_ea;
+			next_address = dsi.vobu_sri.next_vobu == SRI_END_OF_CELL ? 0 : dsi.vobu_sri.next_vobu & 0x3fffffff;
+
+		}
+
+		if(unit_last_sector > last_sector)
+			unit_last_sector = last_sector;
+
+		if(!dvd_extents_add(dvd_extents, sector, unit_last_sector))
+			return -1;
+
+		// The last unit of the cell doesn't point anywhere
+		if(next_address == 0 || next_address & DVD_ANGLE_ADDRESS_INVALID)
+			return 1;
+
+		// Going backwards would never end
+		next_sector = sector + next_address;
+		if(next_sector <= unit_last_sector) {
+			sector = unit_last_sector + 1;
+			break;
+		}
+
+		sector = next_sector;
+
+	}
+
+	if(sector > last_sector)
+		return 1;
+
+	// Lost track of the angle, so the rest of the cell is copied with the
+	// other angles still in it
+	if(!dvd_extents_add(dvd_extents, sector, last_sector))
+		return -1;
+
+	return 0;
+
+}
@@ -0,0 +1,65 @@
+#ifndef DVD_INFO_ANGLE_H
+#define DVD_INFO_ANGLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <dvdread/dvd_reader.h>
+#include <dvdread/nav_read.h>
+#include <dvdread/nav_types.h>
+#include "dvd_extents.h"
+#include "dvd_scan.h"
+
+#ifndef DVD_VIDEO_LB_LEN
+#define DVD_VIDEO_LB_LEN 2048
+#endif
+
+// SML_PBI category flag for a VOBU that is part of an interleaved unit
+#define DVD_ANGLE_ILVU 0x4000
+
+// Relative addresses in the DSI with this set point backwards, or nowhere
+#define DVD_ANGLE_ADDRESS_INVALID 0x80000000
+
+/**
+ * Seamless multi-angle video is stored interleaved. The angles of an angle
+ * block are cut into interleaved units (ILVUs) of a few VOBUs each, and the
+ * units of every angle take turns on the disc:
+ *
+ * | angle 1 | angle 2 | angle 3 | angle 1 | angle 2 | angle 3 | ...
+ *
+ * The cell for each angle runs from its first unit to its last, so its
+ * sector range covers the units of all the other angles too. Copying the
+ * range as is gives every angle, one after the other, a few seconds at a
+ * time.
+ *
+ * Every VOBU starts with a NAV pack, and its DSI packet says where the
+ * current unit ends (ILVU_EA) and where the next unit of the same angle
+ * starts (NT_ILVU_SA), both relative to the NAV pack. Following those from
+ * the first sector of the cell finds only the sectors of that angle, at the
+ * cost of reading one NAV pack per unit.
+ *
+ * Example, angle 2 of 3:
+ * Cell: 05, First sector: 160012, Last sector: 188421
+ *
+ * Extent: 1, First sector: 160012, Last sector: 160871
+ * Extent: 2, First sector: 162644, Last sector: 163509
+ * Extent: 3, First sector: 165290, Last sector: 166138
+ * ...
+ */
+
+/**
+ * Add the sectors of an interleaved angle cell to a list of extents, by
+ * following the ILVU pointers from its first sector. VOBUs that aren't
+ * interleaved are followed one at a time with the VOBU search information
+ * instead.
+ *
+ * If a NAV pack can't be read, or doesn't make sense, there's no way to
+ * tell where the angle goes next, so the rest of the cell is added as it
+ * is. A sector that can't be read is added to bad_sectors.
+ *
+ * Returns 1 if the units were followed to the end of the cell, 0 if the rest
+ * of the cell had to be added as it is, or -1 if memory can't be allocated.
+ */
+int dvd_angle_extents(dvd_file_t *dvdread_vts_file, uint64_t first_sector, uint64_t last_sector, struct dvd_extents *dvd_extents, struct dvd_extents *bad_sectors);
+
+#endif
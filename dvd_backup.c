@@ -11,6 +11,7 @@
 #include <ctype.h>
 #include <libgen.h>
 #include <sys/stat.h>
+#include <sys/statvfs.h>
 #ifdef __linux__
 #include <linux/cdrom.h>
 #include <linux/limits.h>
@@ -26,7 +27,19 @@
 #include "dvd_info.h"
 #include "dvd_vmg_ifo.h"
 #include "dvd_vts.h"
+#include "dvd_track.h"
+#include "dvd_cell.h"
+#include "dvd_time.h"
 #include "dvd_vob.h"
+#include "dvd_output.h"
+#include "dvd_extents.h"
+#include "dvd_source.h"
+#include "dvd_journal.h"
+#include "dvd_speed.h"
+#include "dvd_readahead.h"
+#include "dvd_iso.h"
+#include "dvd_schedule.h"
+#include "dvd_blocks.h"
 
 	/**
 	 *
@@ -50,28 +63,1040 @@
 
 #define DVD_DIR_PATH_MAX (PATH_MAX - strlen("/VIDEO_TS.IFO"))
 
+/**
+ * What copying each file of a backup needs to know
+ */
+struct dvd_backup {
+	dvd_reader_t *dvdread_dvd;
+	const char *device_filename;
+	const char *disc_title;
+	const char *parent_dir;
+	const char *backup_dir;
+	bool resume;
+	bool direct;
+	bool referenced_only;
+	uint64_t read_blocks;
+	uint64_t readahead_blocks;
+	unsigned char *buffer;
+	bool *bad;
+	struct dvd_extents bad_sectors;
+};
+
 int main(int, char **);
-int dvd_block_rw(dvd_file_t *, uint64_t, int);
+ssize_t dvd_blocks_rw(dvd_file_t *, uint64_t, uint64_t, unsigned char *, bool *, struct dvd_output *, struct dvd_journal *, struct dvd_extents *);
+ssize_t dvd_blocks_skip(uint64_t, unsigned char *, struct dvd_output *, struct dvd_journal *);
+bool dvd_backup_referenced(ifo_handle_t *, ifo_handle_t *, uint16_t, struct dvd_extents *);
+uint64_t dvd_backup_referenced_run(struct dvd_extents *, uint64_t, uint64_t, bool *);
+bool dvd_backup_progress_due(bool);
+int dvd_backup_sync(struct dvd_output *, struct dvd_journal *);
+void dvd_backup_bad_sectors(struct dvd_extents *, const char *);
+void dvd_backup_bad_sectors_resume(struct dvd_extents *, const char *, uint64_t);
+int dvd_backup_vob_source(struct dvd_source *, uint64_t, uint64_t, struct dvd_output *);
+bool dvd_backup_vob_complete(const char *, uint64_t);
+bool dvd_backup_vob_open(struct dvd_output *, struct dvd_journal *, const char *, const char *, bool, bool, uint64_t *);
+void dvd_backup_speed_close(void);
+void dvd_backup_readahead_close(void);
+void dvd_backup_vob_readahead(struct dvd_source *, uint64_t, uint64_t);
+void dvd_backup_drive(const char *, uint32_t, bool, uint32_t);
+int dvd_backup_iso(dvd_reader_t *, const char *, const char *, uint16_t, uint64_t, bool, bool);
+bool dvd_backup_ifo(dvd_reader_t *, const char *, uint16_t, bool);
+int dvd_backup_menu_vob(struct dvd_backup *, struct dvd_vts *);
+int dvd_backup_title_vobs(struct dvd_backup *, struct dvd_vts *, struct dvd_extents *);
+
+// Long options that have no short one
+#define DVD_BACKUP_OPT_READAHEAD 256
+#define DVD_BACKUP_OPT_REFERENCED_ONLY 257
+#define DVD_BACKUP_OPT_IFOS_FIRST 258
+
+// How often to update the progress line, in milliseconds
+#define DVD_BACKUP_PROGRESS_MSECS 500
+
+// Drive speed set with --speed, put back however dvd_backup exits
+static struct dvd_speed dvd_backup_speed;
+
+void dvd_backup_speed_close(void) {
+
+	dvd_speed_close(&dvd_backup_speed);
+
+}
+
+// Drive readahead set with --readahead, and the time spent reading VOBs
+static struct dvd_readahead dvd_backup_readahead;
+
+void dvd_backup_readahead_close(void) {
+
+	dvd_readahead_close(&dvd_backup_readahead);
+
+}
+
+/**
+ * Ask for the VOB sectors of an image or directory ahead of libdvdread
+ * reading them, since it only reads one block at a time
+ */
+void dvd_backup_vob_readahead(struct dvd_source *dvd_source, uint64_t sector, uint64_t blocks) {
+
+	uint64_t mapped_blocks = 0;
+	int fd = -1;
+	off_t offset = 0;
+
+	while(blocks) {
+
+		mapped_blocks = dvd_source_map(dvd_source, sector, blocks, &fd, &offset);
+		if(mapped_blocks == 0)
+			return;
+
+		dvd_readahead_file(&dvd_backup_readahead, fd, offset, mapped_blocks);
+
+		sector += mapped_blocks;
+		blocks -= mapped_blocks;
+
+	}
+
+}
+
+/**
+ * Read a run of blocks and write them to the backup file, with one read and
+ * one write for the whole run. If the read fails, it is split up until only
+ * the blocks that can't be read are left (see dvd_read_blocks()). Those are
+ * left as holes in the file, and added to bad_sectors, so dvd_backup skips
+ * them.
+ *
+ * Every so often, the file is synced and the journal is updated, so that the
+ * backup can be resumed from there.
+ *
+ * Returns the number of blocks that couldn't be read, or -1 if the file
+ * couldn't be written.
+ */
+ssize_t dvd_blocks_rw(dvd_file_t *dvdread_vts_file, uint64_t offset, uint64_t blocks, unsigned char *buffer, bool *bad, struct dvd_output *dvd_output, struct dvd_journal *dvd_journal, struct dvd_extents *bad_sectors) {
+
+	uint64_t bad_blocks = 0;
+	uint64_t block = 0;
+
+	bad_blocks = dvd_read_blocks(dvdread_vts_file, offset, blocks, buffer, bad);
+
+	for(block = 0; bad_blocks && block < blocks; block++) {
+		if(bad[block])
+			dvd_extents_add(bad_sectors, offset + block, offset + block);
+	}
+
+	if(dvd_output_write_blocks(dvd_output, buffer, blocks, bad) < 0)
+		return -1;
+
+	if(dvd_journal->file == NULL)
+		return (ssize_t)bad_blocks;
+
+	// Holes read back as zeros, the same as the bad blocks in the buffer
+	dvd_journal_update(dvd_journal, buffer, blocks);
+
+	if(dvd_backup_sync(dvd_output, dvd_journal) == -1)
+		return -1;
+
+	return (ssize_t)bad_blocks;
+
+}
+
+/**
+ * Leave a run of blocks out of the output as a hole, the same as the ones
+ * that can't be read, so the rest of the VOB stays where it is.
+ *
+ * Returns 0, or -1 if the file couldn't be written.
+ */
+ssize_t dvd_blocks_skip(uint64_t blocks, unsigned char *buffer, struct dvd_output *dvd_output, struct dvd_journal *dvd_journal) {
+
+	if(dvd_output_skip(dvd_output, blocks * DVD_VIDEO_LB_LEN) < 0)
+		return -1;
+
+	if(dvd_journal->file == NULL)
+		return 0;
+
+	// Checksum the zeros the hole reads back as, so it can be resumed
+	memset(buffer, '\0', blocks * DVD_VIDEO_LB_LEN);
+	dvd_journal_update(dvd_journal, buffer, blocks);
+
+	if(dvd_backup_sync(dvd_output, dvd_journal) == -1)
+		return -1;
+
+	return 0;
+
+}
+
+/**
+ * Add the sectors of the title VOBs of a title set that are played by its
+ * valid tracks. A track is skipped if it has no length (see
+ * dvd_track_init()), or if its cells go backwards or repeat, which is how
+ * some discs point at the same sectors over and over to break copying.
+ * The extents are sorted, so each sector is in there once.
+ *
+ * Returns false if memory can't be allocated.
+ */
+bool dvd_backup_referenced(ifo_handle_t *vmg_ifo, ifo_handle_t *vts_ifo, uint16_t vts, struct dvd_extents *referenced_sectors) {
+
+	uint16_t tracks = 0;
+	uint16_t track = 0;
+	uint8_t cells = 0;
+	uint8_t cell = 0;
+	uint64_t first_sector = 0;
+	uint64_t last_sector = 0;
+
+	if(vmg_ifo == NULL || vts_ifo == NULL)
+		return true;
+
+	tracks = dvd_tracks(vmg_ifo);
+
+	for(track = 1; track < tracks + 1; track++) {
+
+		if(dvd_vts_ifo_number(vmg_ifo, track) != vts)
+			continue;
+
+		if(dvd_track_msecs(vmg_ifo, vts_ifo, track) == 0)
+			continue;
+
+		if(dvd_track_min_sector_error(vmg_ifo, vts_ifo, track) || dvd_track_max_sector_error(vmg_ifo, vts_ifo, track) || dvd_track_repeat_first_sector_error(vmg_ifo, vts_ifo, track) || dvd_track_repeat_last_sector_error(vmg_ifo, vts_ifo, track))
+			continue;
+
+		cells = dvd_track_cells(vmg_ifo, vts_ifo, track);
+
+		for(cell = 1; cell < cells + 1; cell++) {
+
+			first_sector = dvd_cell_first_sector(vmg_ifo, vts_ifo, track, cell);
+			last_sector = dvd_cell_last_sector(vmg_ifo, vts_ifo, track, cell);
+
+			if(last_sector < first_sector)
+				continue;
+
+			if(!dvd_extents_add(referenced_sectors, first_sector, last_sector))
+				return false;
+
+		}
+
+	}
+
+	dvd_extents_sort(referenced_sectors);
+
+	return true;
+
+}
+
+/**
+ * Find how many blocks from the start of a run are all referenced, or all
+ * not, up to blocks. Whichever it is is set in referenced.
+ */
+uint64_t dvd_backup_referenced_run(struct dvd_extents *referenced_sectors, uint64_t sector, uint64_t blocks, bool *referenced) {
+
+	uint32_t ix = 0;
+	struct dvd_extent *extent = NULL;
+
+	*referenced = false;
+
+	for(ix = 0; ix < referenced_sectors->extents; ix++) {
+
+		extent = &referenced_sectors->extent[ix];
+
+		if(extent->last_sector < sector)
+			continue;
+
+		if(extent->first_sector <= sector) {
+			*referenced = true;
+			if(blocks > extent->last_sector - sector + 1)
+				blocks = extent->last_sector - sector + 1;
+			return blocks;
+		}
+
+		// The extents are sorted, so this is the next one after the run
+		if(blocks > extent->first_sector - sector)
+			blocks = extent->first_sector - sector;
+
+		return blocks;
+
+	}
+
+	return blocks;
+
+}
+
+/**
+ * Progress is displayed on a timer instead of for every read. Returns true
+ * if it's time to update it, or if force is set.
+ */
+bool dvd_backup_progress_due(bool force) {
+
+	static struct timespec last_progress = { 0, 0 };
+	struct timespec now;
+	int64_t msecs = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	msecs = (int64_t)(now.tv_sec - last_progress.tv_sec) * 1000 + (now.tv_nsec - last_progress.tv_nsec) / 1000000;
+	if(!force && msecs < DVD_BACKUP_PROGRESS_MSECS)
+		return false;
+
+	last_progress = now;
+
+	return true;
+
+}
+
+/**
+ * Once enough blocks are pending in the journal, sync the output and commit
+ * them. If the journal can't be written, the backup goes on without it.
+ *
+ * Returns -1 if the output couldn't be synced.
+ */
+int dvd_backup_sync(struct dvd_output *dvd_output, struct dvd_journal *dvd_journal) {
+
+	if(dvd_journal->file == NULL || !dvd_journal_due(dvd_journal))
+		return 0;
+
+	switch(dvd_output_sync(dvd_output)) {
+		case -1:
+			return -1;
+		case 0:
+			if(!dvd_journal_commit(dvd_journal)) {
+				printf("\n* couldn't write journal %s\n", dvd_journal->filename);
+				dvd_journal_close(dvd_journal, false);
+			}
+			break;
+	}
+
+	return 0;
+
+}
+
+/**
+ * Save the sectors of a VOB or an image that couldn't be read, so that a
+ * later pass only has to retry those. This is also done when the backup
+ * fails, since --resume picks the map up again. If nothing is left in the
+ * map, one left over from an earlier backup is removed.
+ */
+void dvd_backup_bad_sectors(struct dvd_extents *bad_sectors, const char *bad_sectors_filename) {
+
+	if(bad_sectors->extents == 0) {
+		unlink(bad_sectors_filename);
+		dvd_extents_free(bad_sectors);
+		return;
+	}
+
+	// Sectors from before the resume point come first
+	dvd_extents_sort(bad_sectors);
+
+	if(dvd_extents_save(bad_sectors, bad_sectors_filename))
+		printf("* bad sectors saved to %s\n", bad_sectors_filename);
+	else
+		printf("* couldn't save bad sectors to %s\n", bad_sectors_filename);
+
+	dvd_extents_free(bad_sectors);
+
+}
+
+/**
+ * With --resume, pick up the map of sectors an earlier pass couldn't read.
+ * Only the sectors before resume_sector are kept, the rest are read again
+ * and go back in the map if they still fail.
+ */
+void dvd_backup_bad_sectors_resume(struct dvd_extents *bad_sectors, const char *bad_sectors_filename, uint64_t resume_sector) {
+
+	struct dvd_extents resumed_sectors;
+	uint32_t ix = 0;
+
+	dvd_extents_init(&resumed_sectors);
+
+	if(!dvd_extents_load(&resumed_sectors, bad_sectors_filename))
+		printf("* couldn't read bad sectors from %s\n", bad_sectors_filename);
+
+	for(ix = 0; ix < resumed_sectors.extents; ix++) {
+		if(resumed_sectors.extent[ix].first_sector >= resume_sector)
+			continue;
+		if(!dvd_extents_add(bad_sectors, resumed_sectors.extent[ix].first_sector, resumed_sectors.extent[ix].last_sector < resume_sector ? resumed_sectors.extent[ix].last_sector : resume_sector - 1)) {
+			printf("* couldn't allocate bad sectors\n");
+			break;
+		}
+	}
+
+	dvd_extents_free(&resumed_sectors);
+
+}
+
+/**
+ * Copy a VOB straight from the files of an unencrypted image or directory,
+ * letting the kernel clone or copy the data, instead of reading it one block
+ * at a time.
+ *
+ * Returns 1 if the VOB was copied, 0 if the source can't be used and the
+ * blocks have to be read from the DVD, or -1 if it couldn't be written.
+ */
+int dvd_backup_vob_source(struct dvd_source *dvd_source, uint64_t first_sector, uint64_t blocks, struct dvd_output *dvd_output) {
+
+	uint64_t sector = first_sector;
+	uint64_t source_blocks = 0;
+	int fd = -1;
+	off_t offset = 0;
+
+	if(blocks == 0 || dvd_source_scrambled(dvd_source, first_sector, first_sector + blocks - 1))
+		return 0;
+
+	while(sector < first_sector + blocks) {
+
+		source_blocks = dvd_source_map(dvd_source, sector, first_sector + blocks - sector, &fd, &offset);
+
+		// Nothing has been written yet if the first part can't be found
+		if(source_blocks == 0 && sector == first_sector)
+			return 0;
+
+		if(source_blocks == 0) {
+			dvd_output->error = EIO;
+			return -1;
+		}
+
+		if(dvd_output_splice(dvd_output, fd, offset, source_blocks * DVD_VIDEO_LB_LEN) < 0)
+			return -1;
+
+		sector += source_blocks;
+
+	}
+
+	return 1;
+
+}
+
+/**
+ * With --resume, a VOB that is the right size, and doesn't have a journal
+ * saying it is only partly done, was finished by an earlier backup. The
+ * journal is created before the VOB is, so a VOB that was only just
+ * created when a backup stopped still has one.
+ *
+ * Space for a VOB is only reserved up front when it has a journal, since
+ * that makes it full size right away. Without one, the VOB only gets to
+ * its full size once the last block is written.
+ */
+bool dvd_backup_vob_complete(const char *vob_filename, uint64_t blocks) {
+
+	char journal_filename[PATH_MAX];
+	struct stat vob_stat;
+
+	snprintf(journal_filename, PATH_MAX, "%s.journal", vob_filename);
+
+	if(access(journal_filename, F_OK) == 0)
+		return false;
+
+	if(stat(vob_filename, &vob_stat) == -1 || !S_ISREG(vob_stat.st_mode))
+		return false;
+
+	return (uint64_t)vob_stat.st_size == blocks * DVD_VIDEO_LB_LEN;
+
+}
+
+/**
+ * Start the journal for a VOB, and create the file, or with resume, open it
+ * to continue after the blocks the journal says are already done.
+ *
+ * Returns false if the VOB can't be opened. A journal that can't be written
+ * only means the backup of this VOB can't be resumed.
+ */
+bool dvd_backup_vob_open(struct dvd_output *dvd_output, struct dvd_journal *dvd_journal, const char *vob_filename, const char *journal_description, bool resume, bool direct, uint64_t *blocks_done) {
+
+	char journal_filename[PATH_MAX];
+
+	snprintf(journal_filename, PATH_MAX, "%s.journal", vob_filename);
+
+	*blocks_done = 0;
+
+	if(resume) {
+		*blocks_done = dvd_journal_resume(journal_filename, journal_description, vob_filename);
+		// Direct writes have to start on an aligned offset
+		if(direct)
+			*blocks_done -= *blocks_done % (DVD_OUTPUT_ALIGN / DVD_VIDEO_LB_LEN);
+	}
+
+	if(!dvd_journal_open(dvd_journal, journal_filename, journal_description, *blocks_done))
+		printf("* couldn't create journal %s, backup can't be resumed\n", journal_filename);
+
+	if(*blocks_done) {
+		printf("* resuming %s at block %" PRIu64 "\n", vob_filename, *blocks_done);
+		if(dvd_output_resume(dvd_output, vob_filename, direct, (off_t)(*blocks_done * DVD_VIDEO_LB_LEN)))
+			return true;
+		*blocks_done = 0;
+	}
+
+	return dvd_output_open(dvd_output, vob_filename, direct);
+
+}
+
+/**
+ * Give up on an output before anything is written to it. Close it and its
+ * journal, and unless an earlier backup had already started it, remove
+ * both, so that nothing is left that looks like progress.
+ */
+void dvd_backup_vob_abort(struct dvd_output *dvd_output, struct dvd_journal *dvd_journal, const char *vob_filename, uint64_t blocks_done) {
+
+	dvd_output_close(dvd_output);
+	dvd_journal_close(dvd_journal, !blocks_done);
+
+	if(!blocks_done)
+		unlink(vob_filename);
+
+}
+
+/**
+ * Set the drive speed and readahead for reading the VOBs, and start timing
+ * them
+ */
+void dvd_backup_drive(const char *device_filename, uint32_t arg_speed, bool opt_speed_auto, uint32_t arg_readahead) {
+
+	if((arg_speed || opt_speed_auto) && !dvd_speed_open(&dvd_backup_speed, device_filename)) {
+		printf("* %s isn't a drive, ignoring --speed\n", device_filename);
+	} else if(arg_speed || opt_speed_auto) {
+		atexit(dvd_backup_speed_close);
+		if(arg_speed && !dvd_speed_set(&dvd_backup_speed, arg_speed))
+			printf("* couldn't set drive speed to %" PRIu32 "x\n", arg_speed);
+		if(opt_speed_auto && !dvd_speed_adaptive(&dvd_backup_speed))
+			printf("* couldn't set drive speed, it won't be adjusted\n");
+		if(dvd_backup_speed.speed)
+			printf("* drive speed: %" PRIu32 "x\n", dvd_backup_speed.speed);
+	}
+
+	atexit(dvd_backup_readahead_close);
+	if(!dvd_readahead_open(&dvd_backup_readahead, device_filename, arg_readahead))
+		printf("* couldn't set readahead of %s\n", device_filename);
+	else if(dvd_backup_readahead.changed)
+		printf("* drive readahead: %lu KiB, was %lu KiB\n", dvd_backup_readahead.sectors / 2, dvd_backup_readahead.saved_sectors / 2);
+
+}
+
+/**
+ * Back up the whole disc to one image, reading it from the first sector to
+ * the last in large runs, with the VOBs decrypted in place (see dvd_iso.h).
+ * Sectors that can't be read are left as holes, and saved to a map next to
+ * the image.
+ */
+int dvd_backup_iso(dvd_reader_t *dvdread_dvd, const char *device_filename, const char *iso_filename, uint16_t video_title_sets, uint64_t read_blocks, bool resume, bool direct) {
+
+	struct dvd_iso dvd_iso;
+	struct dvd_output iso_output;
+	struct dvd_journal iso_journal;
+	struct dvd_extents bad_sectors;
+	char journal_description[PATH_MAX];
+	char bad_sectors_filename[PATH_MAX];
+	unsigned char *buffer = NULL;
+	bool *bad = NULL;
+	uint64_t sector = 0;
+	uint64_t blocks = 0;
+	uint64_t bad_blocks = 0;
+	uint64_t skipped_blocks = 0;
+	uint64_t ix = 0;
+
+	if(!dvd_iso_open(&dvd_iso, dvdread_dvd, device_filename, video_title_sets)) {
+		printf("* %s isn't a drive or a disc image, can't make an ISO\n", device_filename);
+		return 1;
+	}
+
+	printf("[ISO]\n");
+	printf("* Blocks: %" PRIu64 "\n", dvd_iso.blocks);
+	printf("* Filesize: %" PRIu64 "\n", dvd_iso.blocks * DVD_VIDEO_LB_LEN);
+	printf("* VOBs to decrypt: %" PRIu16 "\n", dvd_iso.ranges);
+
+	buffer = calloc(read_blocks, DVD_VIDEO_LB_LEN);
+	bad = calloc(read_blocks, sizeof(bool));
+	if(buffer == NULL || bad == NULL) {
+		printf("* couldn't allocate read buffer\n");
+		free(buffer);
+		free(bad);
+		dvd_iso_close(&dvd_iso);
+		return 1;
+	}
+
+	dvd_extents_init(&bad_sectors);
+	snprintf(bad_sectors_filename, PATH_MAX, "%s.bad", iso_filename);
+
+	snprintf(journal_description, PATH_MAX, "dvd_backup iso %s blocks %" PRIu64, iso_filename, dvd_iso.blocks);
+
+	if(!dvd_backup_vob_open(&iso_output, &iso_journal, iso_filename, journal_description, resume, direct, &sector)) {
+		printf("* could not create %s\n", iso_filename);
+		dvd_journal_close(&iso_journal, false);
+		free(buffer);
+		free(bad);
+		dvd_iso_close(&dvd_iso);
+		return 1;
+	}
+
+	if(dvd_output_reserve(&iso_output, (off_t)(dvd_iso.blocks * DVD_VIDEO_LB_LEN)) == -1) {
+		printf("* could not allocate space for %s: %s\n", iso_filename, strerror(iso_output.error));
+		dvd_backup_vob_abort(&iso_output, &iso_journal, iso_filename, sector);
+		free(buffer);
+		free(bad);
+		dvd_iso_close(&dvd_iso);
+		return 1;
+	}
+
+	if(sector)
+		dvd_backup_bad_sectors_resume(&bad_sectors, bad_sectors_filename, sector);
+
+	while(sector < dvd_iso.blocks) {
+
+		blocks = dvd_iso.blocks - sector;
+		if(blocks > read_blocks)
+			blocks = read_blocks;
+
+		bad_blocks = dvd_iso_read_blocks(&dvd_iso, sector, blocks, buffer, bad);
+		skipped_blocks += bad_blocks;
+
+		dvd_readahead_update(&dvd_backup_readahead, blocks);
+		if(dvd_speed_update(&dvd_backup_speed, blocks, bad_blocks))
+			printf("\n* drive speed: %" PRIu32 "x\n", dvd_backup_speed.speed);
+
+		for(ix = 0; bad_blocks && ix < blocks; ix++) {
+			if(bad[ix])
+				dvd_extents_add(&bad_sectors, sector + ix, sector + ix);
+		}
+
+		if(dvd_output_write_blocks(&iso_output, buffer, blocks, bad) < 0) {
+			printf("\n* couldn't write to %s: %s\n", iso_filename, strerror(iso_output.error));
+			dvd_backup_bad_sectors(&bad_sectors, bad_sectors_filename);
+			free(buffer);
+			free(bad);
+			dvd_iso_close(&dvd_iso);
+			return 1;
+		}
+
+		if(iso_journal.file != NULL)
+			dvd_journal_update(&iso_journal, buffer, blocks);
+
+		if(dvd_backup_sync(&iso_output, &iso_journal) == -1) {
+			printf("\n* couldn't write to %s: %s\n", iso_filename, strerror(iso_output.error));
+			dvd_backup_bad_sectors(&bad_sectors, bad_sectors_filename);
+			free(buffer);
+			free(bad);
+			dvd_iso_close(&dvd_iso);
+			return 1;
+		}
+
+		sector += blocks;
+
+		if(dvd_backup_progress_due(sector == dvd_iso.blocks)) {
+			fprintf(stdout, "* %s blocks written: %" PRIu64 " of %" PRIu64 ", skipped: %" PRIu64 "\r", iso_filename, sector, dvd_iso.blocks, skipped_blocks);
+			fflush(stdout);
+		}
+
+	}
+
+	printf("\n");
+
+	free(buffer);
+	free(bad);
+
+	if(dvd_output_close(&iso_output) == -1) {
+		printf("* couldn't write to %s: %s\n", iso_filename, strerror(iso_output.error));
+		dvd_backup_bad_sectors(&bad_sectors, bad_sectors_filename);
+		dvd_iso_close(&dvd_iso);
+		return 1;
+	}
+
+	dvd_journal_close(&iso_journal, true);
+
+	printf("* blocks decrypted: %" PRIu64 "\n", dvd_iso.decrypted_blocks);
+	printf("* read: %.0lf MBs in %.2lf seconds: %.1lf MB/s\n", dvd_backup_readahead.blocks * DVD_VIDEO_LB_LEN / 1048576.0, dvd_readahead_seconds(&dvd_backup_readahead), dvd_readahead_mbs(&dvd_backup_readahead));
+
+	dvd_backup_bad_sectors(&bad_sectors, bad_sectors_filename);
+	dvd_iso_close(&dvd_iso);
+
+	return 0;
+
+}
+
+/**
+ * Copy an IFO, or its backup BUP, to the backup directory.
+ *
+ * Returns false if the file can't be created.
+ */
+bool dvd_backup_ifo(dvd_reader_t *dvdread_dvd, const char *dvd_backup_dir, uint16_t ifo_number, bool info_file) {
+
+	ssize_t dvd_backup_blocks = 0;
+	char dvd_backup_filename[PATH_MAX];
+	memset(dvd_backup_filename, '\0', PATH_MAX);
+
+	ssize_t ifo_bytes_read = 0;
+	ssize_t ifo_bytes_written = 0;
+
+	ssize_t dvd_block = 0;
+	dvd_file_t *dvdread_ifo_file = NULL;
+
+	uint8_t ifo_buffer[DVD_VIDEO_LB_LEN];
+	memset(ifo_buffer, '\0', DVD_VIDEO_LB_LEN);
+	char vts_filename[13]; // Example string: VIDEO_TS.IFO
+	memset(vts_filename, '\0', 13);
+	int ifo_fd = -1;
+
+	// The .IFO is on the inside of the optical disc, while the .BUP is on the outside.
+	dvdread_ifo_file = DVDOpenFile(dvdread_dvd, ifo_number, info_file ? DVD_READ_INFO_FILE : DVD_READ_INFO_BACKUP_FILE);
+
+	if(dvdread_ifo_file == 0) {
+		// printf("* Opening IFO FAILED\n");
+		// printf("* Skipping IFO\n");
+		return true;
+	}
+
+	// Get the number of blocks plus filesize
+	dvd_backup_blocks = DVDFileSize(dvdread_ifo_file);
+
+	if(dvd_backup_blocks < 0) {
+		// printf("* Could not determine IFO filesize, skipping\n");
+		DVDCloseFile(dvdread_ifo_file);
+		return true;
+	}
+
+	// Seek to beginning of file
+	DVDFileSeek(dvdread_ifo_file, 0);
+
+	dvd_schedule_filename(vts_filename, sizeof(vts_filename), info_file ? DVD_SCHEDULE_IFO : DVD_SCHEDULE_BUP, ifo_number);
+	snprintf(dvd_backup_filename, PATH_MAX - 1, "%s/%s", dvd_backup_dir, vts_filename);
+
+	printf("* Writing to %s\n", vts_filename);
+	ifo_fd = open(dvd_backup_filename, O_WRONLY|O_CREAT|O_TRUNC, 0666);
+	if(ifo_fd == -1) {
+		printf("* Could not create %s\n", vts_filename);
+		DVDCloseFile(dvdread_ifo_file);
+		return false;
+	}
+
+	// In the case of IFOs and BUPs, be pedantic and read only one block at a time plus
+	// always count one as written
+	while(dvd_block < dvd_backup_blocks) {
+		ifo_bytes_read = DVDReadBytes(dvdread_ifo_file, ifo_buffer, DVD_VIDEO_LB_LEN);
+		if(ifo_bytes_read < 0)
+			memset(ifo_buffer, '\0', DVD_VIDEO_LB_LEN);
+		ifo_bytes_written = write(ifo_fd, ifo_buffer, DVD_VIDEO_LB_LEN);
+		dvd_block++;
+	}
+
+	close(ifo_fd);
+	DVDCloseFile(dvdread_ifo_file);
+
+	return true;
+
+}
+
+/**
+ * Copy the menu VOB of a title set, or VIDEO_TS.VOB.
+ *
+ * Returns 1 if the VOB can't be written, and the backup has to stop.
+ */
+int dvd_backup_menu_vob(struct dvd_backup *dvd_backup, struct dvd_vts *dvd_vts) {
+
+	int retval = 0;
+	uint16_t vts = dvd_vts->vts;
+	struct dvd_output vob_output;
+	struct dvd_source vob_source;
+	struct dvd_journal vob_journal;
+	char journal_description[PATH_MAX];
+	uint64_t vob_blocks_done = 0;
+	char vob_filename[PATH_MAX];
+	char bad_sectors_filename[PATH_MAX];
+	uint64_t dvd_blocks_offset = 0;
+	uint64_t dvd_blocks_skipped = 0;
+	uint64_t read_blocks = 0;
+	ssize_t bad_blocks = 0;
+	dvd_file_t *dvdread_vts_file = NULL;
+
+	// Skip if the file doesn't exist on the DVD
+	dvdread_vts_file = DVDOpenFile(dvd_backup->dvdread_dvd, vts, DVD_READ_MENU_VOBS);
+	if(dvdread_vts_file == 0)
+		return 0;
+
+	if(vts == 0)
+		snprintf(vob_filename, PATH_MAX - 1, "%s/VIDEO_TS.VOB", dvd_backup->backup_dir);
+	else
+		snprintf(vob_filename, PATH_MAX - 1, "%s/VTS_%02" PRIu16  "_0.VOB", dvd_backup->backup_dir, vts);
+
+	snprintf(bad_sectors_filename, PATH_MAX - 1, "%s%s.bad", dvd_backup->parent_dir, strrchr(vob_filename, '/') + 1);
+
+	if(dvd_backup->resume && dvd_backup_vob_complete(vob_filename, dvd_vts->dvd_vobs[0].blocks)) {
+		printf("* %s already backed up\n", vob_filename);
+		DVDCloseFile(dvdread_vts_file);
+		return 0;
+	}
+
+	snprintf(journal_description, PATH_MAX, "dvd_backup %s %s blocks %" PRIu64, dvd_backup->disc_title, strrchr(vob_filename, '/') + 1, dvd_vts->dvd_vobs[0].blocks);
+
+	if(!dvd_backup_vob_open(&vob_output, &vob_journal, vob_filename, journal_description, dvd_backup->resume, dvd_backup->direct, &vob_blocks_done)) {
+		printf("* could not create %s\n", vob_filename);
+		dvd_journal_close(&vob_journal, false);
+		DVDCloseFile(dvdread_vts_file);
+		return 1;
+	}
+
+	// It's not unusual for a DVD to have a placeholder VOB, if
+	// that's the case, skip it after it's been created by open().
+	if(dvd_vts->dvd_vobs[0].blocks == 0) {
+		dvd_output_close(&vob_output);
+		dvd_journal_close(&vob_journal, true);
+		DVDCloseFile(dvdread_vts_file);
+		return 0;
+	}
+
+	if(vob_journal.file != NULL && dvd_output_reserve(&vob_output, (off_t)(dvd_vts->dvd_vobs[0].blocks * DVD_VIDEO_LB_LEN)) == -1) {
+		printf("* could not allocate space for %s: %s\n", vob_filename, strerror(vob_output.error));
+		dvd_backup_vob_abort(&vob_output, &vob_journal, vob_filename, vob_blocks_done);
+		DVDCloseFile(dvdread_vts_file);
+		return 1;
+	}
+
+	if(vob_blocks_done)
+		dvd_backup_bad_sectors_resume(&dvd_backup->bad_sectors, bad_sectors_filename, vob_blocks_done);
+
+	dvd_blocks_offset = vob_blocks_done;
+	dvd_blocks_skipped = 0;
+
+	// Unencrypted images and directories can be copied by the kernel
+	if(dvd_source_open(&vob_source, dvd_backup->dvdread_dvd, dvd_backup->device_filename, vts, true)) {
+
+		retval = dvd_backup_vob_source(&vob_source, dvd_blocks_offset, dvd_vts->dvd_vobs[0].blocks - dvd_blocks_offset, &vob_output);
+		dvd_source_close(&vob_source);
+
+		if(retval == -1) {
+			printf("* couldn't write to %s: %s\n", vob_filename, strerror(vob_output.error));
+			dvd_backup_bad_sectors(&dvd_backup->bad_sectors, bad_sectors_filename);
+			return 1;
+		}
+
+		if(retval == 1) {
+			dvd_readahead_update(&dvd_backup_readahead, dvd_vts->dvd_vobs[0].blocks - dvd_blocks_offset);
+			dvd_blocks_offset = dvd_vts->dvd_vobs[0].blocks;
+			fprintf(stdout, "* %s blocks written: %" PRIu64 " of %" PRIu64 " (copied from source)", vob_filename, dvd_blocks_offset, dvd_vts->dvd_vobs[0].blocks);
+		}
+
+	}
+
+	while(dvd_blocks_offset < dvd_vts->dvd_vobs[0].blocks) {
+
+		read_blocks = dvd_vts->dvd_vobs[0].blocks - dvd_blocks_offset;
+		if(read_blocks > dvd_backup->read_blocks)
+			read_blocks = dvd_backup->read_blocks;
+
+		bad_blocks = dvd_blocks_rw(dvdread_vts_file, dvd_blocks_offset, read_blocks, dvd_backup->buffer, dvd_backup->bad, &vob_output, &vob_journal, &dvd_backup->bad_sectors);
+
+		// Couldn't write
+		if(bad_blocks == -1) {
+			fprintf(stdout, "* couldn't write to %s\n", vob_filename);
+			fflush(stdout);
+			dvd_backup_bad_sectors(&dvd_backup->bad_sectors, bad_sectors_filename);
+			return 1;
+		}
+
+		dvd_readahead_update(&dvd_backup_readahead, read_blocks);
+		if(dvd_speed_update(&dvd_backup_speed, read_blocks, (uint64_t)bad_blocks))
+			printf("\n* drive speed: %" PRIu32 "x\n", dvd_backup_speed.speed);
+
+		dvd_blocks_skipped += (uint64_t)bad_blocks;
+		dvd_blocks_offset += read_blocks;
+
+		if(dvd_backup_progress_due(dvd_blocks_offset == dvd_vts->dvd_vobs[0].blocks)) {
+			fprintf(stdout, "* %s blocks written: %" PRIu64 " of %" PRIu64 "\r", vob_filename, dvd_blocks_offset, dvd_vts->dvd_vobs[0].blocks);
+			fflush(stdout);
+		}
+
+	}
+
+	printf("\n");
+
+	if(dvd_output_close(&vob_output) == -1) {
+		printf("* couldn't write to %s: %s\n", vob_filename, strerror(vob_output.error));
+		dvd_backup_bad_sectors(&dvd_backup->bad_sectors, bad_sectors_filename);
+		return 1;
+	}
+
+	dvd_journal_close(&vob_journal, true);
+
+	dvd_backup_bad_sectors(&dvd_backup->bad_sectors, bad_sectors_filename);
+
+	DVDCloseFile(dvdread_vts_file);
+
+	return 0;
+
+}
 
 /**
- * Read and write to the backup file. If there is an error, quit, and
- * dvd_backup will skip the blocks.
+ * Copy the title VOBs of a title set. libdvdread reads them as one file, so
+ * they are read in one pass, and each one is written to its own file.
+ *
+ * Returns 1 if a VOB can't be written, and the backup has to stop.
  */
-int dvd_block_rw(dvd_file_t *dvdread_vts_file, uint64_t offset, int fd) {
+int dvd_backup_title_vobs(struct dvd_backup *dvd_backup, struct dvd_vts *dvd_vts, struct dvd_extents *referenced_sectors) {
+
+	int retval = 0;
+	uint16_t vts = dvd_vts->vts;
+	uint16_t vob = 0;
+	uint64_t vob_block = 0;
+	struct dvd_output vob_output;
+	struct dvd_source vob_source;
+	bool vob_source_open = false;
+	struct dvd_journal vob_journal;
+	char journal_description[PATH_MAX];
+	uint64_t vob_blocks_done = 0;
+	char vob_filename[PATH_MAX];
+	char bad_sectors_filename[PATH_MAX];
+	uint64_t dvd_blocks_offset = 0;
+	ssize_t vob_blocks_skipped = 0;
+	uint64_t read_blocks = 0;
+	ssize_t bad_blocks = 0;
+	bool referenced = true;
+	uint64_t readahead_sector = 0;
+	uint16_t readahead_part = 0;
+	dvd_file_t *dvdread_vts_file = NULL;
 
-	ssize_t bytes_read = 0;
-	unsigned char buffer[DVD_VIDEO_LB_LEN];
+	dvdread_vts_file = DVDOpenFile(dvd_backup->dvdread_dvd, vts, DVD_READ_TITLE_VOBS);
 
-	bytes_read = DVDReadBlocks(dvdread_vts_file, (size_t)offset, 1, buffer);
+	if(dvdread_vts_file == 0)
+		return 0;
 
-	if(bytes_read < 0)
-		return 1;
+	vob_source_open = dvd_source_open(&vob_source, dvd_backup->dvdread_dvd, dvd_backup->device_filename, vts, false);
+	readahead_sector = 0;
+
+	for(readahead_part = 0; vob_source_open && dvd_backup->readahead_blocks && readahead_part < vob_source.parts; readahead_part++)
+		dvd_readahead_sequential(vob_source.part[readahead_part].fd);
+
+	printf("[VTS %d]\n", vts);
+
+	printf("* Blocks: %" PRIu64 "\n", dvd_vts->blocks);
+	printf("* Filesize: %zu\n", dvd_vts->filesize);
+	printf("* VOBs: %u\n", dvd_vts->vobs);
+
+	for(vob = 1; vob < dvd_vts->vobs + 1; vob++)
+		if(dvd_vts->dvd_vobs[vob].blocks)
+			printf("* VOB %i filesize: %zu\n", vob, dvd_vob_filesize(dvd_backup->dvdread_dvd, vts, vob));
+
+	if(dvd_backup->referenced_only)
+		printf("* Referenced blocks: %" PRIu64 "\n", referenced_sectors->blocks);
+
+	dvd_blocks_offset = 0;
+
+	for(vob = 1; vob < dvd_vts->vobs + 1; vob++) {
+
+		snprintf(vob_filename, PATH_MAX - 1, "%s/VTS_%02" PRIu16 "_%" PRIu16 ".VOB", dvd_backup->backup_dir, vts, vob);
+		snprintf(bad_sectors_filename, PATH_MAX - 1, "%s%s.bad", dvd_backup->parent_dir, strrchr(vob_filename, '/') + 1);
 
-	ssize_t bytes_written = 0;
-	bytes_written = write(fd, buffer, DVD_VIDEO_LB_LEN);
+		if(dvd_backup->resume && dvd_backup_vob_complete(vob_filename, dvd_vts->dvd_vobs[vob].blocks)) {
+			printf("* %s already backed up\n", vob_filename);
+			dvd_blocks_offset += dvd_vts->dvd_vobs[vob].blocks;
+			continue;
+		}
+
+		snprintf(journal_description, PATH_MAX, "dvd_backup %s %s blocks %" PRIu64, dvd_backup->disc_title, strrchr(vob_filename, '/') + 1, dvd_vts->dvd_vobs[vob].blocks);
+
+		if(!dvd_backup_vob_open(&vob_output, &vob_journal, vob_filename, journal_description, dvd_backup->resume, dvd_backup->direct, &vob_blocks_done)) {
+			printf("* could not create %s\n", vob_filename);
+			dvd_journal_close(&vob_journal, false);
+			if(vob_source_open)
+				dvd_source_close(&vob_source);
+			DVDCloseFile(dvdread_vts_file);
+			return 1;
+		}
+
+		// Blocks that aren't referenced are holes, so don't allocate them,
+		// and without a journal, the size is how --resume knows it's done
+		if(!dvd_backup->referenced_only && vob_journal.file != NULL && dvd_output_reserve(&vob_output, (off_t)(dvd_vts->dvd_vobs[vob].blocks * DVD_VIDEO_LB_LEN)) == -1) {
+			printf("* could not allocate space for %s: %s\n", vob_filename, strerror(vob_output.error));
+			dvd_backup_vob_abort(&vob_output, &vob_journal, vob_filename, vob_blocks_done);
+			if(vob_source_open)
+				dvd_source_close(&vob_source);
+			DVDCloseFile(dvdread_vts_file);
+			return 1;
+		}
+
+		vob_block = vob_blocks_done;
+		dvd_blocks_offset += vob_blocks_done;
+		vob_blocks_skipped = 0;
+
+		if(vob_blocks_done)
+			dvd_backup_bad_sectors_resume(&dvd_backup->bad_sectors, bad_sectors_filename, dvd_blocks_offset);
+
+		if(vob_source_open && !dvd_backup->referenced_only) {
+
+			retval = dvd_backup_vob_source(&vob_source, dvd_blocks_offset, dvd_vts->dvd_vobs[vob].blocks - vob_block, &vob_output);
+
+			if(retval == -1) {
+				printf("* couldn't write to %s: %s\n", vob_filename, strerror(vob_output.error));
+				dvd_backup_bad_sectors(&dvd_backup->bad_sectors, bad_sectors_filename);
+				return 1;
+			}
+
+			if(retval == 1) {
+				dvd_readahead_update(&dvd_backup_readahead, dvd_vts->dvd_vobs[vob].blocks - vob_block);
+				dvd_blocks_offset += dvd_vts->dvd_vobs[vob].blocks - vob_block;
+				vob_block = dvd_vts->dvd_vobs[vob].blocks;
+				fprintf(stdout, "* %s blocks written: %" PRIu64 " of %" PRIu64 " (copied from source)", vob_filename, vob_block, dvd_vts->dvd_vobs[vob].blocks);
+			}
+
+		}
+
+		while(vob_block < dvd_vts->dvd_vobs[vob].blocks) {
+
+			read_blocks = dvd_vts->dvd_vobs[vob].blocks - vob_block;
+			if(read_blocks > dvd_backup->read_blocks)
+				read_blocks = dvd_backup->read_blocks;
+
+			// Stop where the run of referenced sectors, or the gap
+			// between them, ends
+			referenced = true;
+			if(dvd_backup->referenced_only)
+				read_blocks = dvd_backup_referenced_run(referenced_sectors, dvd_blocks_offset, read_blocks, &referenced);
+
+			if(referenced) {
+
+				// Stay one readahead window ahead of libdvdread
+				if(vob_source_open && dvd_backup->readahead_blocks && dvd_blocks_offset >= readahead_sector) {
+					dvd_backup_vob_readahead(&vob_source, dvd_blocks_offset + read_blocks, dvd_backup->readahead_blocks);
+					readahead_sector = dvd_blocks_offset + dvd_backup->readahead_blocks;
+				}
+
+				bad_blocks = dvd_blocks_rw(dvdread_vts_file, dvd_blocks_offset, read_blocks, dvd_backup->buffer, dvd_backup->bad, &vob_output, &vob_journal, &dvd_backup->bad_sectors);
+
+			} else {
+
+				bad_blocks = dvd_blocks_skip(read_blocks, dvd_backup->buffer, &vob_output, &vob_journal);
+
+			}
+
+			// Couldn't write
+			if(bad_blocks == -1) {
+				printf("* couldn't write to %s\n", vob_filename);
+				dvd_backup_bad_sectors(&dvd_backup->bad_sectors, bad_sectors_filename);
+				return 1;
+			}
+
+			if(referenced) {
+				dvd_readahead_update(&dvd_backup_readahead, read_blocks);
+				if(dvd_speed_update(&dvd_backup_speed, read_blocks, (uint64_t)bad_blocks))
+					printf("\n* drive speed: %" PRIu32 "x\n", dvd_backup_speed.speed);
+			}
+
+			vob_blocks_skipped += bad_blocks;
+			dvd_blocks_offset += read_blocks;
+			vob_block += read_blocks;
+
+			if(dvd_backup_progress_due(vob_block == dvd_vts->dvd_vobs[vob].blocks)) {
+				fprintf(stdout, "* %s blocks written: %" PRIu64 " of %" PRIu64 ", skipped: %" PRIu64 "\r", vob_filename, vob_block, dvd_vts->dvd_vobs[vob].blocks, vob_blocks_skipped);
+				fflush(stdout);
+			}
+
+		}
+
+		if(dvd_output_close(&vob_output) == -1) {
+			printf("\n* couldn't write to %s: %s\n", vob_filename, strerror(vob_output.error));
+			dvd_backup_bad_sectors(&dvd_backup->bad_sectors, bad_sectors_filename);
+			return 1;
+		}
+
+		dvd_journal_close(&vob_journal, true);
+
+		printf("\n");
+
+		dvd_backup_bad_sectors(&dvd_backup->bad_sectors, bad_sectors_filename);
 
-	if(bytes_written < 0)
-		return 2;
+	}
+
+	if(vob_source_open)
+		dvd_source_close(&vob_source);
+
+	DVDCloseFile(dvdread_vts_file);
 
 	return 0;
 
@@ -86,7 +1111,15 @@ int main(int argc, char **argv) {
 		{ "help", no_argument, NULL, 'h' },
 		{ "name", required_argument, NULL, 'n' },
 		{ "ifos", no_argument, NULL, 'i' },
+		{ "read-blocks", required_argument, NULL, 'b' },
+		{ "iso", no_argument, NULL, 'I' },
+		{ "direct", no_argument, NULL, 'D' },
+		{ "resume", no_argument, NULL, 'r' },
 		{ "vts", required_argument, NULL, 'T' },
+		{ "speed", required_argument, NULL, 'x' },
+		{ "readahead", required_argument, NULL, DVD_BACKUP_OPT_READAHEAD },
+		{ "referenced-only", no_argument, NULL, DVD_BACKUP_OPT_REFERENCED_ONLY },
+		{ "ifos-first", no_argument, NULL, DVD_BACKUP_OPT_IFOS_FIRST },
 		{ "version", no_argument, NULL, 'V' },
 		{ 0, 0, 0, 0 },
 	};
@@ -96,16 +1129,40 @@ int main(int argc, char **argv) {
 	opterr = 1;
 
 	bool opt_title_sets = true;
+	bool opt_iso = false;
+	uint64_t arg_read_blocks = DVD_READ_BLOCKS;
+	unsigned char *vob_buffer = NULL;
+	bool *vob_bad = NULL;
+	bool opt_direct = false;
+	bool opt_resume = false;
 	bool opt_vts_number = false;
 	uint16_t arg_vts_number = 0;
+	bool opt_speed_auto = false;
+	uint32_t arg_speed = 0;
+	char *speed_end = NULL;
+	uint32_t arg_readahead = 0;
+	bool opt_referenced_only = false;
+	bool opt_ifos_first = false;
 
 	char dvd_custom_dir[PATH_MAX];
 	memset(dvd_custom_dir, '\0', PATH_MAX);
 
-	while((opt = getopt_long(argc, argv, "hin:T:V", p_long_opts, &ix)) != -1) {
+	while((opt = getopt_long(argc, argv, "b:DhiIn:rT:Vx:", p_long_opts, &ix)) != -1) {
 
 		switch(opt) {
 
+			case 'b':
+				arg_read_blocks = strtoul(optarg, NULL, 10);
+				if(arg_read_blocks < 1 || arg_read_blocks > DVD_READ_BLOCKS_MAX) {
+					printf("Read blocks must be between 1 and %i\n", DVD_READ_BLOCKS_MAX);
+					return 1;
+				}
+				break;
+
+			case 'D':
+				opt_direct = true;
+				break;
+
 			case 'h':
 				printf("dvd_backup - backup a DVD\n");
 				printf("\n");
@@ -114,7 +1171,15 @@ int main(int argc, char **argv) {
 				printf("Options:\n");
 				printf("  -n, --name            Set DVD name\n");
 				printf("  -i, --ifos            Back up only the IFO and BUP files\n");
+				printf("  -I, --iso             Back up the whole disc to one image, decrypted\n");
 				printf("  -T, --vts <number>    Back up video title set number (default: all)\n");
+				printf("  -D, --direct          Write VOBs bypassing the page cache\n");
+				printf("  -b, --read-blocks <#> Number of blocks to read at once (default: %i)\n", DVD_READ_BLOCKS);
+				printf("  -r, --resume          Continue an earlier backup that didn't finish\n");
+				printf("  -x, --speed <#|auto>  Set drive read speed, or lower it on read errors\n");
+				printf("      --readahead <KiB> Read further ahead while copying (suggested: %i)\n", DVD_READAHEAD_KBS);
+				printf("      --referenced-only Copy only the title VOB sectors valid tracks play\n");
+				printf("      --ifos-first      Copy IFOs, then menus, then titles, instead of in disc order\n");
 				printf("\n");
 				printf("DVD path can be a device name, a single file, or a directory (default: %s)\n", DEFAULT_DVD_DEVICE);
 				return 0;
@@ -128,6 +1193,14 @@ int main(int argc, char **argv) {
 				opt_title_sets = false;
 				break;
 
+			case 'I':
+				opt_iso = true;
+				break;
+
+			case 'r':
+				opt_resume = true;
+				break;
+
 			case 'T':
 				opt_vts_number = true;
 				arg_vts_number = (uint16_t)strtoumax(optarg, NULL, 0);
@@ -142,6 +1215,34 @@ int main(int argc, char **argv) {
 				return 0;
 				break;
 
+			case 'x':
+				if(strcmp(optarg, "auto") == 0) {
+					opt_speed_auto = true;
+					break;
+				}
+				arg_speed = (uint32_t)strtoul(optarg, &speed_end, 10);
+				if(*speed_end != '\0' || arg_speed < DVD_SPEED_MIN || arg_speed > DVD_SPEED_MAX) {
+					printf("Speed must be auto, or between %i and %i\n", DVD_SPEED_MIN, DVD_SPEED_MAX);
+					return 1;
+				}
+				break;
+
+			case DVD_BACKUP_OPT_READAHEAD:
+				arg_readahead = (uint32_t)strtoul(optarg, NULL, 10);
+				if(arg_readahead < DVD_READAHEAD_KBS_MIN || arg_readahead > DVD_READAHEAD_KBS_MAX) {
+					printf("Readahead must be between %i and %i KiB\n", DVD_READAHEAD_KBS_MIN, DVD_READAHEAD_KBS_MAX);
+					return 1;
+				}
+				break;
+
+			case DVD_BACKUP_OPT_REFERENCED_ONLY:
+				opt_referenced_only = true;
+				break;
+
+			case DVD_BACKUP_OPT_IFOS_FIRST:
+				opt_ifos_first = true;
+				break;
+
 			case 0:
 			default:
 				break;
@@ -150,6 +1251,11 @@ int main(int argc, char **argv) {
 
 	}
 
+	if(opt_iso && (!opt_title_sets || opt_vts_number || opt_referenced_only)) {
+		printf("--iso backs up the whole disc, and can't be used with --ifos, --vts or --referenced-only\n");
+		return 1;
+	}
+
 	memset(device_filename, '\0', PATH_MAX);
 	if (argv[optind])
 		strncpy(device_filename, argv[optind], PATH_MAX - 1);
@@ -195,6 +1301,18 @@ int main(int argc, char **argv) {
 			backup_title[l] = toupper(backup_title[l]);
 	}
 
+	// The whole disc goes to one image, named like the directory would be
+	char iso_filename[PATH_MAX];
+	memset(iso_filename, '\0', PATH_MAX);
+	if(opt_iso) {
+		snprintf(iso_filename, DVD_DIR_PATH_MAX - 1, "%s.iso", strlen(dvd_custom_dir) ? dvd_custom_dir : backup_title);
+		dvd_backup_drive(device_filename, arg_speed, opt_speed_auto, arg_readahead);
+		retval = dvd_backup_iso(dvdread_dvd, device_filename, iso_filename, dvd_info.video_title_sets, arg_read_blocks, opt_resume, opt_direct);
+		dvd_vts_stat_reset();
+		DVDClose(dvdread_dvd);
+		return retval;
+	}
+
 	// Build the backup directory
 	char dvd_parent_dir[PATH_MAX];
 	char dvd_backup_dir[PATH_MAX];
@@ -229,137 +1347,49 @@ int main(int argc, char **argv) {
 		return 1;
 	}
 
-	/**
-	 * Backup the .IFO and .BUP info files first, followed by the menu VOBS, and then finally
-	 * the actual title set VOBs. The reason being that the IFO and BUPs are most likely to
-	 * able to be read and copied, the menus as well because of their small size, and the
-	 * video title sets will cause the most problems, if any.
-	 */
-
-	// Keep track of each backup in one struct
-	ssize_t dvd_backup_blocks = 0;
-	char dvd_backup_filename[PATH_MAX];
-	memset(dvd_backup_filename, '\0', PATH_MAX);
-
-	// Start with the primary IFO first, and the backup BUP second
-	bool info_file = true;
-	bool ifo_backed_up = false;
-	bool bup_backed_up = false;
-
-	ssize_t ifo_bytes_read = 0;
-	ssize_t ifo_bytes_written = 0;
-
-	ssize_t dvd_block = 0;
-	dvd_file_t *dvdread_ifo_file = NULL;
-
-	// Loop through all the IFOs and copy the .IFO and .BUP files
 	uint16_t ifo_number = 0;
-	uint8_t ifo_buffer[DVD_VIDEO_LB_LEN];
-	memset(ifo_buffer, '\0', DVD_VIDEO_LB_LEN);
-	char vts_filename[23]; // Example string: VIDEO_TS/VIDEO_TS.VOB
-	memset(vts_filename, '\0', 23);
 	ifo_handle_t *ifo = NULL;
-	int ifo_fd = -1;
-	for (ifo_number = 0; ifo_number < dvd_info.video_title_sets + 1; ifo_number++) {
-
-		// Always write the VMG IFO, and skip others if optional one is passed
-		if(ifo_number && opt_vts_number && arg_vts_number != ifo_number)
-			continue;
 
-		info_file = true;
-		ifo_backed_up = false;
-		bup_backed_up = false;
+	// Only the IFO and BUP files, which are in order on the disc already
+	if(opt_title_sets == false) {
 
-		ifo = ifoOpen(dvdread_dvd, ifo_number);
-
-		// TODO work around broken IFOs by copying contents directly to filesystem
-		if(ifo == NULL) {
-			// printf("* Opening IFO FAILED\n");
-			// printf("* Skipping IFO\n");
-			continue;
-		}
+		for(ifo_number = 0; ifo_number < dvd_info.video_title_sets + 1; ifo_number++) {
 
-		// Loop to backup both
-		while(ifo_backed_up == false || bup_backed_up == false) {
+			// Always write the VMG IFO, and skip others if optional one is passed
+			if(ifo_number && opt_vts_number && arg_vts_number != ifo_number)
+				continue;
 
-			// The .IFO is on the inside of the optical disc, while the .BUP is on the outside.
-			dvdread_ifo_file = DVDOpenFile(dvdread_dvd, ifo_number, info_file ? DVD_READ_INFO_FILE : DVD_READ_INFO_BACKUP_FILE);
+			ifo = ifoOpen(dvdread_dvd, ifo_number);
 
-			if(dvdread_ifo_file == 0) {
+			// TODO work around broken IFOs by copying contents directly to filesystem
+			if(ifo == NULL) {
 				// printf("* Opening IFO FAILED\n");
 				// printf("* Skipping IFO\n");
-				ifoClose(ifo);
-				ifo = NULL;
-				continue;
-			}
-
-			// Get the number of blocks plus filesize
-			dvd_backup_blocks = DVDFileSize(dvdread_ifo_file);
-
-			if(dvd_backup_blocks < 0) {
-				// printf("* Could not determine IFO filesize, skipping\n");
-				ifoClose(ifo);
-				ifo = NULL;
 				continue;
 			}
 
-			// Seek to beginning of file
-			DVDFileSeek(dvdread_ifo_file, 0);
-
-			if(ifo_number == 0) {
-				sprintf(vts_filename, "VIDEO_TS.%s", info_file ? "IFO" : "BUP");
-				snprintf(dvd_backup_filename, PATH_MAX - 1, "%s/%s", dvd_backup_dir, vts_filename);
-			} else {
-				sprintf(vts_filename, "VTS_%02" PRIu16 "_0.%s", ifo_number, info_file ? "IFO" : "BUP");
-				snprintf(dvd_backup_filename, PATH_MAX - 1, "%s/%s", dvd_backup_dir, vts_filename);
-			}
+			ifoClose(ifo);
+			ifo = NULL;
 
-			printf("* Writing to %s\n", vts_filename);
-			ifo_fd = open(dvd_backup_filename, O_WRONLY|O_CREAT|O_TRUNC, 0666);
-			if(ifo_fd == -1) {
-				printf("* Could not create %s\n", vts_filename);
+			if(!dvd_backup_ifo(dvdread_dvd, dvd_backup_dir, ifo_number, true) || !dvd_backup_ifo(dvdread_dvd, dvd_backup_dir, ifo_number, false))
 				return 1;
-			}
-
-			// Read / write IFO or BUP
-			memset(ifo_buffer, '\0', DVD_VIDEO_LB_LEN);
-			dvd_block = 0;
-			ifo_bytes_read = 0;
-			ifo_bytes_written = 0;
-
-			// In the case of IFOs and BUPs, be pedantic and read only one block at a time plus
-			// always count one as written
-			while(dvd_block < dvd_backup_blocks) {
-				ifo_bytes_read = DVDReadBytes(dvdread_ifo_file, ifo_buffer, DVD_VIDEO_LB_LEN);
-				if(ifo_bytes_read < 0)
-					memset(ifo_buffer, '\0', DVD_VIDEO_LB_LEN);
-				ifo_bytes_written = write(ifo_fd, ifo_buffer, DVD_VIDEO_LB_LEN);
-				dvd_block++;
-			}
-
-			retval = close(ifo_fd);
-
-			// Switch to next one
-			if(info_file) {
-				ifo_backed_up = true;
-				info_file = false;
-			} else {
-				bup_backed_up = true;
-			}
 
 		}
 
-		ifoClose(ifo);
-		ifo = NULL;
+		return 0;
 
 	}
 
-	// Exit if only writing IFO / BUP files
-	if(opt_title_sets == false)
-		return 0;
+	// Set the drive speed and readahead for reading the VOBs
+	dvd_backup_drive(device_filename, arg_speed, opt_speed_auto, arg_readahead);
 
-	/** VOB copy variables **/
-	uint64_t vob_block = 0;
+	// VOBs are read arg_read_blocks at a time
+	vob_buffer = calloc(arg_read_blocks, DVD_VIDEO_LB_LEN);
+	vob_bad = calloc(arg_read_blocks, sizeof(bool));
+	if(vob_buffer == NULL || vob_bad == NULL) {
+		printf("* couldn't allocate read buffer\n");
+		return 1;
+	}
 
 	uint16_t vts = 1;
 	struct dvd_vts dvd_vts[99];
@@ -370,6 +1400,9 @@ int main(int argc, char **argv) {
 
 	uint16_t vob = 0;
 
+	// Sectors of the title VOBs that valid tracks play, for --referenced-only
+	struct dvd_extents referenced_sectors[DVD_MAX_VTS_IFOS];
+
 	// Scan VTS for invalid data
 	for(vts = 0; vts < dvd_info.video_title_sets + 1; vts++) {
 
@@ -378,6 +1411,7 @@ int main(int argc, char **argv) {
 		dvd_vts[vts].blocks = 0;
 		dvd_vts[vts].filesize = 0;
 		dvd_vts[vts].vobs = 0;
+		dvd_extents_init(&referenced_sectors[vts]);
 
 		vts_ifos[vts] = ifoOpen(dvdread_dvd, vts);
 
@@ -413,153 +1447,177 @@ int main(int argc, char **argv) {
 			dvd_vts[vts].dvd_vobs[vob].blocks = dvd_vob_blocks(dvdread_dvd, vts, vob);
 		}
 
+		if(opt_referenced_only && vts && !dvd_backup_referenced(vts_ifos[0], vts_ifos[vts], vts, &referenced_sectors[vts])) {
+			printf("* couldn't allocate memory for the referenced sectors\n");
+			return 1;
+		}
+
 	}
 
-	// Create blank placeholder VOBs which will be populated
-	// Also copy just the menu title sets for now. On broken DVDs, the
-	// title VOBs could be garbage, so they will be copied later.
-	int vob_fd = -1;
+	// Make sure all the VOBs will fit before reading any of them. Files
+	// from an earlier backup are overwritten, so their space counts as free.
+	uint64_t backup_bytes = 0;
+	uint64_t free_bytes = 0;
+	struct statvfs backup_statvfs;
+	struct stat vob_stat;
 	char vob_filename[PATH_MAX];
 	memset(vob_filename, '\0', PATH_MAX);
 
-	/** Backup VIDEO_TS.VOB **/
-	snprintf(vob_filename, PATH_MAX - 1, "%s/VIDEO_TS.VOB", dvd_backup_dir);
+	if(statvfs(dvd_backup_dir, &backup_statvfs) == 0) {
 
-	uint64_t dvd_blocks_offset = 0;
-	uint64_t dvd_blocks_skipped = 0;
-
-	// Copy the menu title vobs
-	/** Backup VIDEO_TS.VOB, VTS_01_0.VOB to VTS_99_0.VOB **/
-	dvd_file_t *dvdread_vts_file = NULL;
-	for(vts = 0; vts < dvd_info.video_title_sets + 1; vts++) {
-
-		// If passed the --vts argument, skip if not this one
-		if(opt_vts_number && arg_vts_number != vts)
-			continue;
+		free_bytes = (uint64_t)backup_statvfs.f_bavail * backup_statvfs.f_frsize;
 
-		// Skip if the file doesn't exist on the DVD
-		dvdread_vts_file = DVDOpenFile(dvdread_dvd, vts, DVD_READ_MENU_VOBS);
-		if(dvdread_vts_file == 0)
-			continue;
+		for(vts = 0; vts < dvd_info.video_title_sets + 1; vts++) {
 
-		if(vts == 0)
-			snprintf(vob_filename, PATH_MAX - 1, "%s/VIDEO_TS.VOB", dvd_backup_dir);
-		else
-			snprintf(vob_filename, PATH_MAX - 1, "%s/VTS_%02" PRIu16  "_0.VOB", dvd_backup_dir, vts);
+			if(opt_vts_number && arg_vts_number != vts)
+				continue;
 
-		vob_fd = open(vob_filename, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+			if(dvd_vts[vts].valid == false)
+				continue;
 
-		// It's not unusual for a DVD to have a placeholder VOB, if
-		// that's the case, skip it after it's been created by open().
-		if(dvd_vts[vts].dvd_vobs[0].blocks == 0) {
-			close(vob_fd);
-			continue;
-		}
+			// Only the referenced sectors of the title VOBs take up space
+			if(opt_referenced_only && vts)
+				backup_bytes += (dvd_vts[vts].dvd_vobs[0].blocks + referenced_sectors[vts].blocks) * DVD_VIDEO_LB_LEN;
 
-		dvd_blocks_offset = 0;
-		dvd_blocks_skipped = 0;
+			for(vob = 0; vob < dvd_vts[vts].vobs + 1; vob++) {
 
-		while(dvd_blocks_offset < dvd_vts[vts].dvd_vobs[0].blocks) {
+				if(!opt_referenced_only || vts == 0)
+					backup_bytes += dvd_vts[vts].dvd_vobs[vob].blocks * DVD_VIDEO_LB_LEN;
 
-			retval = dvd_block_rw(dvdread_vts_file, dvd_blocks_offset, vob_fd);
+				if(vts == 0)
+					snprintf(vob_filename, PATH_MAX - 1, "%s/VIDEO_TS.VOB", dvd_backup_dir);
+				else
+					snprintf(vob_filename, PATH_MAX - 1, "%s/VTS_%02" PRIu16 "_%" PRIu16 ".VOB", dvd_backup_dir, vts, vob);
 
-			// Skipped a block
-			if(retval == 1)
-				dvd_blocks_skipped++;
+				if(stat(vob_filename, &vob_stat) == 0)
+					free_bytes += (uint64_t)vob_stat.st_blocks * 512;
 
-			// Couldn't write
-			if(retval == 2) {
-				fprintf(stdout, "* couldn't write to %s\n", vob_filename);
-				fflush(stdout);
-				return 1;
 			}
 
-			fprintf(stdout, "* %s blocks written: %" PRIu64 " of %" PRIu64 "\r", vob_filename, dvd_blocks_offset + 1, dvd_vts[vts].dvd_vobs[0].blocks);
-			fflush(stdout);
-
-			dvd_blocks_offset++;
-
 		}
 
-		printf("\n");
+		if(backup_bytes > free_bytes) {
+			printf("* not enough free space in %s: %.0lf MBs needed, %.0lf MBs available\n", dvd_backup_dir, ceil(backup_bytes / 1048576.0), floor(free_bytes / 1048576.0));
+			return 1;
+		}
 
-		close(vob_fd);
+	}
 
-		vob_fd = -1;
+	struct dvd_backup dvd_backup;
+	memset(&dvd_backup, 0, sizeof(struct dvd_backup));
+	dvd_backup.dvdread_dvd = dvdread_dvd;
+	dvd_backup.device_filename = device_filename;
+	dvd_backup.disc_title = dvd_info.title;
+	dvd_backup.parent_dir = dvd_parent_dir;
+	dvd_backup.backup_dir = dvd_backup_dir;
+	dvd_backup.resume = opt_resume;
+	dvd_backup.direct = opt_direct;
+	dvd_backup.referenced_only = opt_referenced_only;
+	dvd_backup.read_blocks = arg_read_blocks;
+	dvd_backup.readahead_blocks = arg_readahead / 2;
+	dvd_backup.buffer = vob_buffer;
+	dvd_backup.bad = vob_bad;
+	dvd_extents_init(&dvd_backup.bad_sectors);
 
-		DVDCloseFile(dvdread_vts_file);
+	/**
+	 * Files are added to the schedule with the .IFO and .BUP info files first, followed by
+	 * the menu VOBS, and then finally the actual title set VOBs. The reason being that the
+	 * IFO and BUPs are most likely to able to be read and copied, the menus as well because
+	 * of their small size, and the video title sets will cause the most problems, if any.
+	 *
+	 * Unless that order is asked for with --ifos-first, the files are then put in the order
+	 * they are on the disc, so it is read in one sweep (see dvd_schedule.h).
+	 */
+	struct dvd_schedule dvd_schedule;
+	struct dvd_schedule_file *schedule_file = NULL;
+	uint16_t schedule_ix = 0;
+	struct dvd_layout dvd_layout;
+	bool dvd_layout_opened = false;
 
-	}
+	// Read where every file is from the filesystem of a drive or image
+	dvd_layout_opened = dvd_layout_open(&dvd_layout, device_filename);
+	dvd_schedule_init(&dvd_schedule, dvd_layout_opened ? &dvd_layout : NULL);
 
-	/** Backup VTS_01_1.VOB through VTS_99_9.VOB **/
-	ssize_t vob_blocks_skipped = 0;
-	for(vts = 1; vts < dvd_info.video_title_sets + 1; vts++) {
+	for(vts = 0; vts < dvd_info.video_title_sets + 1; vts++) {
 
-		if(opt_vts_number && arg_vts_number != vts)
+		// Always write the VMG IFO, and skip others if optional one is passed
+		if(vts && opt_vts_number && arg_vts_number != vts)
 			continue;
 
-		if(dvd_vts[vts].valid == false)
+		// TODO work around broken IFOs by copying contents directly to filesystem
+		if(vts_ifos[vts] == NULL)
 			continue;
 
-		dvdread_vts_file = DVDOpenFile(dvdread_dvd, vts, DVD_READ_TITLE_VOBS);
+		dvd_schedule_add(&dvd_schedule, DVD_SCHEDULE_IFO, vts);
+		dvd_schedule_add(&dvd_schedule, DVD_SCHEDULE_BUP, vts);
+
+	}
+
+	// Copy just the menu title sets next. On broken DVDs, the title VOBs
+	// could be garbage, so they will be copied later.
+	for(vts = 0; vts < dvd_info.video_title_sets + 1; vts++) {
 
-		if(dvdread_vts_file == 0)
+		// If passed the --vts argument, skip if not this one
+		if(opt_vts_number && arg_vts_number != vts)
 			continue;
 
-		printf("[VTS %d]\n", vts);
+		dvd_schedule_add(&dvd_schedule, DVD_SCHEDULE_MENU_VOB, vts);
 
-		printf("* Blocks: %" PRIu64 "\n", dvd_vts[vts].blocks);
-		printf("* Filesize: %zu\n", dvd_vts[vts].filesize);
-		printf("* VOBs: %u\n", dvd_vts[vts].vobs);
+	}
+
+	for(vts = 1; vts < dvd_info.video_title_sets + 1; vts++) {
 
-		for(vob = 1; vob < dvd_vts[vts].vobs + 1; vob++)
-			if(dvd_vts[vts].dvd_vobs[vob].blocks)
-				printf("* VOB %i filesize: %zu\n", vob, dvd_vob_filesize(dvdread_dvd, vts, vob));
+		if(opt_vts_number && arg_vts_number != vts)
+			continue;
 
-		dvd_blocks_offset = 0;
+		if(dvd_vts[vts].valid == false)
+			continue;
 
-		for(vob = 1; vob < dvd_vts[vts].vobs + 1; vob++) {
+		dvd_schedule_add(&dvd_schedule, DVD_SCHEDULE_TITLE_VOBS, vts);
 
-			snprintf(vob_filename, PATH_MAX - 1, "%s/VTS_%02" PRIu16 "_%" PRIu16 ".VOB", dvd_backup_dir, vts, vob);
+	}
 
-			vob_fd = open(vob_filename, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+	if(!opt_ifos_first && dvd_schedule_sort(&dvd_schedule))
+		printf("* Backing up files in the order they are on the disc\n");
 
-			vob_block = 0;
-			vob_blocks_skipped = 0;
+	if(dvd_layout_opened)
+		dvd_layout_free(&dvd_layout);
 
-			while(vob_block < dvd_vts[vts].dvd_vobs[vob].blocks) {
+	for(schedule_ix = 0; schedule_ix < dvd_schedule.files; schedule_ix++) {
 
-				retval = dvd_block_rw(dvdread_vts_file, dvd_blocks_offset, vob_fd);
+		schedule_file = &dvd_schedule.file[schedule_ix];
 
-				// Skipped a block
-				if(retval == 1)
-					vob_blocks_skipped++;
+		switch(schedule_file->type) {
 
-				// Couldn't write
-				if(retval == 2) {
-					printf("* couldn't write to %s\n", vob_filename);
+			case DVD_SCHEDULE_IFO:
+			case DVD_SCHEDULE_BUP:
+				if(!dvd_backup_ifo(dvdread_dvd, dvd_backup_dir, schedule_file->vts, schedule_file->type == DVD_SCHEDULE_IFO))
 					return 1;
-				}
-
-				fprintf(stdout, "* %s blocks written: %" PRIu64 " of %" PRIu64 ", skipped: %" PRIu64 "\r", vob_filename, vob_block + 1, dvd_vts[vts].dvd_vobs[vob].blocks, vob_blocks_skipped);
-				fflush(stdout);
+				break;
 
-				dvd_blocks_offset++;
-				vob_block++;
+			case DVD_SCHEDULE_MENU_VOB:
+				if(dvd_backup_menu_vob(&dvd_backup, &dvd_vts[schedule_file->vts]))
+					return 1;
+				break;
 
-			}
+			case DVD_SCHEDULE_TITLE_VOBS:
+				if(dvd_backup_title_vobs(&dvd_backup, &dvd_vts[schedule_file->vts], &referenced_sectors[schedule_file->vts]))
+					return 1;
+				break;
 
-			close(vob_fd);
+		}
 
-			vob_fd = -1;
+	}
 
-			printf("\n");
+	for(vts = 0; vts < dvd_info.video_title_sets + 1; vts++)
+		dvd_extents_free(&referenced_sectors[vts]);
 
-		}
+	free(vob_buffer);
+	free(vob_bad);
 
-		DVDCloseFile(dvdread_vts_file);
+	printf("* VOBs read: %.0lf MBs in %.2lf seconds: %.1lf MB/s\n", dvd_backup_readahead.blocks * DVD_VIDEO_LB_LEN / 1048576.0, dvd_readahead_seconds(&dvd_backup_readahead), dvd_readahead_mbs(&dvd_backup_readahead));
 
-	}
+	dvd_vts_stat_reset();
 
 	if(dvdread_dvd)
 		DVDClose(dvdread_dvd);
@@ -0,0 +1,39 @@
+#include "dvd_blocks.h"
+
+/**
+ * Functions used to read runs of DVD blocks
+ */
+
+uint64_t dvd_read_blocks(dvd_file_t *dvdread_file, uint64_t offset, uint64_t blocks, unsigned char *buffer, bool *bad) {
+
+	if(blocks == 0)
+		return 0;
+
+	ssize_t blocks_read = 0;
+	blocks_read = DVDReadBlocks(dvdread_file, (int)offset, (size_t)blocks, buffer);
+
+	if(blocks_read == (ssize_t)blocks) {
+		if(bad != NULL)
+			memset(bad, false, blocks * sizeof(bool));
+		return 0;
+	}
+
+	// A single block that can't be read gets zeroed out
+	if(blocks == 1) {
+		memset(buffer, '\0', DVD_VIDEO_LB_LEN);
+		if(bad != NULL)
+			bad[0] = true;
+		return 1;
+	}
+
+	// Split the range and try each half on its own, so that only the bad
+	// sectors are lost
+	uint64_t first_half = blocks / 2;
+	uint64_t bad_blocks = 0;
+
+	bad_blocks += dvd_read_blocks(dvdread_file, offset, first_half, buffer, bad);
+	bad_blocks += dvd_read_blocks(dvdread_file, offset + first_half, blocks - first_half, buffer + (first_half * DVD_VIDEO_LB_LEN), bad == NULL ? NULL : bad + first_half);
+
+	return bad_blocks;
+
+}
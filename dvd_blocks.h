@@ -0,0 +1,37 @@
+#ifndef DVD_INFO_BLOCKS_H
+#define DVD_INFO_BLOCKS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <dvdread/dvd_reader.h>
+
+#ifndef DVD_VIDEO_LB_LEN
+#define DVD_VIDEO_LB_LEN 2048
+#endif
+
+// Default number of blocks to request per read, 512 blocks is 1 MiB
+#define DVD_READ_BLOCKS 512
+
+// Upper limit of blocks per read, 8 MiB
+#define DVD_READ_BLOCKS_MAX 4096
+
+/**
+ * Read a run of blocks from a DVD file into a buffer that is at least
+ * blocks * DVD_VIDEO_LB_LEN in size.
+ *
+ * Reading one block at a time means one syscall (and on a drive, one
+ * command) for every 2 KiB, so copies should ask for large runs instead.
+ * If a large read fails, the range is split in half and each half is read
+ * again, until only the single blocks that can't be read are left. Those
+ * are zeroed out in the buffer.
+ *
+ * If bad is not NULL, it is set for each block, true if the block could not
+ * be read, so that the output can leave a hole there instead.
+ *
+ * Returns the number of blocks that could not be read.
+ */
+uint64_t dvd_read_blocks(dvd_file_t *dvdread_file, uint64_t offset, uint64_t blocks, unsigned char *buffer, bool *bad);
+
+#endif
@@ -42,6 +42,55 @@ uint64_t dvd_cell_last_sector(ifo_handle_t *vmg_ifo, ifo_handle_t *vts_ifo, uint
 
 }
 
+uint8_t dvd_cell_angle(ifo_handle_t *vmg_ifo, ifo_handle_t *vts_ifo, uint16_t track_number, uint8_t cell_number) {
+
+	if(vts_ifo->vts_pgcit == NULL || vts_ifo->vts_ptt_srpt == NULL || vts_ifo->vts_ptt_srpt->title == NULL)
+		return 0;
+
+	uint8_t ttn = dvd_track_ttn(vmg_ifo, track_number);
+	pgcit_t *vts_pgcit = vts_ifo->vts_pgcit;
+	pgc_t *pgc = vts_pgcit->pgci_srp[vts_ifo->vts_ptt_srpt->title[ttn - 1].ptt[0].pgcn - 1].pgc;
+
+	if(pgc == NULL || pgc->program_map == NULL || pgc->cell_playback == NULL)
+		return 0;
+
+	cell_playback_t *cell_playback = &pgc->cell_playback[cell_number - 1];
+
+	if(cell_playback->block_type != BLOCK_TYPE_ANGLE_BLOCK || cell_playback->block_mode == BLOCK_MODE_NOT_IN_BLOCK)
+		return 0;
+
+	// Count back to the first cell in the block
+	uint8_t angle = 1;
+	uint8_t cell_ix = cell_number - 1;
+
+	while(cell_ix > 0 && pgc->cell_playback[cell_ix].block_mode != BLOCK_MODE_FIRST_CELL) {
+		cell_ix--;
+		angle++;
+	}
+
+	return angle;
+
+}
+
+bool dvd_cell_interleaved(ifo_handle_t *vmg_ifo, ifo_handle_t *vts_ifo, uint16_t track_number, uint8_t cell_number) {
+
+	if(vts_ifo->vts_pgcit == NULL || vts_ifo->vts_ptt_srpt == NULL || vts_ifo->vts_ptt_srpt->title == NULL)
+		return false;
+
+	uint8_t ttn = dvd_track_ttn(vmg_ifo, track_number);
+	pgcit_t *vts_pgcit = vts_ifo->vts_pgcit;
+	pgc_t *pgc = vts_pgcit->pgci_srp[vts_ifo->vts_ptt_srpt->title[ttn - 1].ptt[0].pgcn - 1].pgc;
+
+	if(pgc == NULL || pgc->program_map == NULL || pgc->cell_playback == NULL)
+		return false;
+
+	if(pgc->cell_playback[cell_number - 1].interleaved)
+		return true;
+
+	return false;
+
+}
+
 /**
  * There's no need to check for an invalid number of blocks, the smallest I've
  * seen is 3. Should be good.
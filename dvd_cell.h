@@ -32,6 +32,22 @@ uint64_t dvd_cell_last_sector(ifo_handle_t *vmg_ifo, ifo_handle_t *vts_ifo, uint
  */
 uint64_t dvd_cell_blocks(ifo_handle_t *vmg_ifo, ifo_handle_t *vts_ifo, uint16_t track_number, uint8_t cell_number);
 
+/**
+ * Multi-angle tracks have an angle block wherever the angles differ, which is
+ * a run of cells, one for each angle, that play in place of each other.
+ *
+ * Returns the angle the cell is for, starting at 1, or 0 if the cell isn't
+ * in an angle block and plays on every angle.
+ */
+uint8_t dvd_cell_angle(ifo_handle_t *vmg_ifo, ifo_handle_t *vts_ifo, uint16_t track_number, uint8_t cell_number);
+
+/**
+ * Check if the cells of an angle block are interleaved with each other, so
+ * that each one covers the sectors of the other angles as well. See
+ * dvd_angle.h.
+ */
+bool dvd_cell_interleaved(ifo_handle_t *vmg_ifo, ifo_handle_t *vts_ifo, uint16_t track_number, uint8_t cell_number);
+
 uint64_t dvd_cell_filesize(ifo_handle_t *vmg_ifo, ifo_handle_t *vts_ifo, uint16_t track_number, uint8_t cell_number);
 
 double dvd_cell_filesize_mbs(ifo_handle_t *vmg_ifo, ifo_handle_t *vts_ifo, uint16_t track_number, uint8_t cell_number);
@@ -9,6 +9,7 @@
 #include <fcntl.h>
 #include <stdbool.h>
 #include <getopt.h>
+#include <pthread.h>
 #ifdef __linux__
 #include <linux/cdrom.h>
 #include <linux/limits.h>
@@ -31,11 +32,38 @@
 #include "dvd_audio.h"
 #include "dvd_subtitles.h"
 #include "dvd_time.h"
+#include "dvd_blocks.h"
+#include "dvd_ring.h"
+#include "dvd_output.h"
+#include "dvd_extents.h"
+#include "dvd_source.h"
+#include "dvd_journal.h"
+#include "dvd_angle.h"
+#include "dvd_demux.h"
+#include "dvd_index.h"
+#include "dvd_scan.h"
+#include "dvd_speed.h"
+#include "dvd_readahead.h"
+#include <dvdread/nav_read.h>
+#include <dvdread/nav_types.h>
 
 #ifndef DVD_VIDEO_LB_LEN
 #define DVD_VIDEO_LB_LEN 2048
 #endif
 
+// What --split starts a new file at
+#define DVD_COPY_SPLIT_NONE 0
+#define DVD_COPY_SPLIT_CHAPTERS 1
+#define DVD_COPY_SPLIT_CELLS 2
+
+// A track has at most 255 cells, and so at most that many files to split into
+#define DVD_COPY_PARTS_MAX 255
+
+// Long options that have no short one
+#define DVD_COPY_OPT_RAW_RETRIES 256
+#define DVD_COPY_OPT_RAW_TIMEOUT 257
+#define DVD_COPY_OPT_READAHEAD 258
+
 	/**
 	 *      _          _
 	 *   __| |_   ____| |    ___ ___  _ __  _   _
@@ -50,6 +78,43 @@
 
 int main(int, char **);
 void dvd_track_info(struct dvd_track *dvd_track, uint16_t track_number, ifo_handle_t *vmg_ifo, ifo_handle_t *vts_ifo);
+void *dvd_copy_writer(void *);
+void *dvd_copy_tracks_writer(void *);
+
+/**
+ * One of the tracks being copied with --tracks, and where its sectors go
+ */
+struct dvd_copy_track {
+	uint16_t track;
+	uint16_t vts;
+	struct dvd_extents dvd_extents;
+	char filename[PATH_MAX];
+	struct dvd_output dvd_output;
+	uint64_t bad_blocks;
+	struct dvd_extents bad_sectors;
+};
+
+/**
+ * A cell being copied, and how far into the copy it starts, to find the
+ * chapter, cell and time of each VOBU for --index
+ */
+struct dvd_copy_cell {
+	uint64_t first_sector;
+	uint64_t last_sector;
+	uint8_t chapter;
+	uint8_t cell;
+	uint32_t msecs;
+};
+
+/**
+ * One of the files a track is split into with --split, and where it starts
+ * in the blocks that are copied
+ */
+struct dvd_copy_part {
+	uint8_t number;
+	uint64_t first_block;
+	uint64_t blocks;
+};
 
 struct dvd_copy {
 	uint16_t track;
@@ -61,10 +126,704 @@ struct dvd_copy {
 	uint64_t filesize;
 	double filesize_mbs;
 	char filename[PATH_MAX];
-	int fd;
-	unsigned char buffer[DVD_VIDEO_LB_LEN];
+	bool direct;
+	struct dvd_output dvd_output;
+	bool zero_copy;
+	bool source;
+	struct dvd_source dvd_source;
+	uint64_t read_blocks;
+	uint64_t bad_blocks;
+	struct dvd_extents bad_sectors;
+	char bad_sectors_filename[PATH_MAX];
+	uint32_t ring_buffers;
+	struct dvd_ring dvd_ring;
+	struct dvd_extents dvd_extents;
+	bool journal;
+	struct dvd_journal dvd_journal;
+	char journal_filename[PATH_MAX];
+	uint64_t resume_blocks;
+	uint16_t tracks;
+	struct dvd_copy_track *dvd_copy_tracks;
+	uint8_t angle;
+	bool demux;
+	struct dvd_demux dvd_demux;
+	bool index;
+	struct dvd_index dvd_index;
+	uint32_t speed;
+	bool speed_auto;
+	struct dvd_speed dvd_speed;
+	bool raw;
+	uint32_t raw_retries;
+	uint32_t raw_timeout;
+	struct dvd_drive_reader dvd_drive_reader;
+	uint32_t readahead_kbs;
+	struct dvd_readahead dvd_readahead;
+	bool readahead_source;
+	uint64_t index_blocks;
+	uint32_t cells;
+	struct dvd_copy_cell dvd_copy_cells[DVD_COPY_PARTS_MAX];
+	uint32_t cell;
+	uint8_t split;
+	char split_template[PATH_MAX];
+	uint32_t parts;
+	struct dvd_copy_part dvd_copy_parts[DVD_COPY_PARTS_MAX];
+	uint32_t part;
+	uint64_t part_blocks;
+	ssize_t bytes_written;
+	bool write_error;
 };
 
+void dvd_copy_release(struct dvd_copy *dvd_copy);
+ssize_t dvd_copy_write(struct dvd_copy *dvd_copy, struct dvd_ring_slot *slot, uint64_t block, uint64_t blocks);
+ssize_t dvd_copy_split_write(struct dvd_copy *dvd_copy, struct dvd_ring_slot *slot);
+ssize_t dvd_copy_demux_write(struct dvd_copy *dvd_copy, struct dvd_ring_slot *slot);
+void dvd_copy_index_blocks(struct dvd_copy *dvd_copy, unsigned char *buffer, uint64_t blocks);
+void dvd_copy_speed(struct dvd_copy *dvd_copy, const char *device_filename, bool debug);
+bool dvd_copy_raw_open(struct dvd_copy *dvd_copy, dvd_reader_t *dvdread_dvd, dvd_file_t *dvdread_vts_file, const char *device_filename, uint16_t vts, bool debug);
+uint64_t dvd_copy_read_blocks(struct dvd_copy *dvd_copy, dvd_file_t *dvdread_vts_file, uint64_t offset, uint64_t blocks, unsigned char *buffer, bool *bad);
+void dvd_copy_readahead_open(struct dvd_copy *dvd_copy, const char *device_filename, bool debug);
+void dvd_copy_readahead_source(struct dvd_copy *dvd_copy, dvd_reader_t *dvdread_dvd, const char *device_filename, uint16_t vts);
+void dvd_copy_readahead(struct dvd_copy *dvd_copy, struct dvd_extent *extent);
+int dvd_copy_split_next(struct dvd_copy *dvd_copy);
+void dvd_copy_split_filename(char *filename, const char *split_template, uint16_t track, uint8_t number);
+bool dvd_copy_bad_sectors_resume(struct dvd_copy *dvd_copy);
+void dvd_copy_bad_sectors_save(struct dvd_copy *dvd_copy);
+int dvd_copy_tracks(struct dvd_copy *dvd_copy, dvd_reader_t *dvdread_dvd, ifo_handle_t *vmg_ifo, ifo_handle_t **vts_ifos, struct dvd_track *dvd_tracks, uint16_t first_track, uint16_t last_track, const char *device_filename, bool debug);
+
+/**
+ * Writer thread: drain the ring of blocks read from the DVD to the output
+ * file, and display progress as it goes. Reading and writing run on their
+ * own threads so that a slow drive and slow output storage overlap instead
+ * of adding up.
+ */
+void *dvd_copy_writer(void *arg) {
+
+	struct dvd_copy *dvd_copy = arg;
+	struct dvd_ring_slot *slot = NULL;
+	ssize_t bytes_written = 0;
+	int sync_retval = 0;
+	double mbs_written = 0;
+	double percent_complete = 0;
+
+	while((slot = dvd_ring_read_slot(&dvd_copy->dvd_ring)) != NULL) {
+
+		if(dvd_copy->split)
+			bytes_written = dvd_copy_split_write(dvd_copy, slot);
+		else if(dvd_copy->demux)
+			bytes_written = dvd_copy_demux_write(dvd_copy, slot);
+		else
+			bytes_written = dvd_copy_write(dvd_copy, slot, 0, slot->blocks);
+
+		// Spliced sectors never pass through here, so they can't be
+		// checksummed
+		if(dvd_copy->journal && bytes_written >= 0)
+			dvd_journal_update(&dvd_copy->dvd_journal, slot->source_fd == -1 ? slot->buffer : NULL, slot->blocks);
+
+		slot->output_offset = dvd_copy->dvd_output.offset;
+		dvd_ring_pop(&dvd_copy->dvd_ring);
+
+		if(dvd_copy->zero_copy)
+			dvd_copy_release(dvd_copy);
+
+		// Once the output is on disk, record how far along the copy is
+		if(dvd_copy->journal && bytes_written >= 0 && dvd_journal_due(&dvd_copy->dvd_journal)) {
+			sync_retval = dvd_output_sync(&dvd_copy->dvd_output);
+			if(sync_retval < 0)
+				bytes_written = -1;
+			else if(sync_retval == 0 && !dvd_journal_commit(&dvd_copy->dvd_journal)) {
+				fprintf(stderr, "\n[dvd_copy] Couldn't write journal %s\n", dvd_copy->journal_filename);
+				dvd_journal_close(&dvd_copy->dvd_journal, false);
+				dvd_copy->journal = false;
+			}
+		}
+
+		if(bytes_written < 0) {
+			dvd_copy->write_error = true;
+			dvd_ring_abort(&dvd_copy->dvd_ring);
+			break;
+		}
+
+		dvd_copy->bytes_written += bytes_written;
+		mbs_written = ceil(dvd_copy->bytes_written / 1048576.0);
+
+		percent_complete = floor((mbs_written / dvd_copy->filesize_mbs) * 100.0);
+		if(percent_complete >= 100.0)
+			percent_complete = 99.0;
+
+		fprintf(stderr, "Progress: %.0lf/%.0lf MBs (%.0lf%%)\r", mbs_written, dvd_copy->filesize_mbs, percent_complete);
+		fflush(stderr);
+
+	}
+
+	return NULL;
+
+}
+
+/**
+ * Write blocks of a slot to the output. Sectors from an unencrypted source go
+ * straight from the file, and blocks that couldn't be read are left as holes.
+ */
+ssize_t dvd_copy_write(struct dvd_copy *dvd_copy, struct dvd_ring_slot *slot, uint64_t block, uint64_t blocks) {
+
+	if(dvd_copy->index && slot->source_fd == -1)
+		dvd_copy_index_blocks(dvd_copy, slot->buffer + block * DVD_VIDEO_LB_LEN, blocks);
+
+	if(slot->source_fd != -1)
+		return dvd_output_splice(&dvd_copy->dvd_output, slot->source_fd, slot->source_offset + (off_t)(block * DVD_VIDEO_LB_LEN), blocks * DVD_VIDEO_LB_LEN);
+
+	return dvd_output_write_blocks(&dvd_copy->dvd_output, slot->buffer + block * DVD_VIDEO_LB_LEN, blocks, slot->bad_blocks ? slot->bad + block : NULL);
+
+}
+
+/**
+ * With --split, write the blocks of a slot to the files they belong to,
+ * moving on to the next file at each chapter or cell where it starts.
+ * Returns the number of bytes written, or -1 on error.
+ */
+ssize_t dvd_copy_split_write(struct dvd_copy *dvd_copy, struct dvd_ring_slot *slot) {
+
+	uint64_t block = 0;
+	uint64_t blocks = 0;
+
+	while(block < slot->blocks) {
+
+		if(dvd_copy->part == 0 || dvd_copy->part_blocks == dvd_copy->dvd_copy_parts[dvd_copy->part - 1].blocks) {
+			if(dvd_copy_split_next(dvd_copy) < 0)
+				return -1;
+			continue;
+		}
+
+		blocks = dvd_copy->dvd_copy_parts[dvd_copy->part - 1].blocks - dvd_copy->part_blocks;
+		if(blocks > slot->blocks - block)
+			blocks = slot->blocks - block;
+
+		if(dvd_copy_write(dvd_copy, slot, block, blocks) < 0)
+			return -1;
+
+		dvd_copy->part_blocks += blocks;
+		block += blocks;
+
+	}
+
+	return (ssize_t)(slot->blocks * DVD_VIDEO_LB_LEN);
+
+}
+
+/**
+ * With --aid or --sid, drop the packs of the streams that aren't selected
+ * before writing the rest. Returns the number of bytes of the slot that were
+ * handled, the same as if all of it was written, or -1 on error.
+ */
+ssize_t dvd_copy_demux_write(struct dvd_copy *dvd_copy, struct dvd_ring_slot *slot) {
+
+	uint64_t blocks = 0;
+
+	blocks = dvd_demux_blocks(&dvd_copy->dvd_demux, slot->buffer, slot->bad_blocks ? slot->bad : NULL, slot->blocks);
+
+	if(blocks && dvd_copy_write(dvd_copy, slot, 0, blocks) < 0)
+		return -1;
+
+	return (ssize_t)(slot->blocks * DVD_VIDEO_LB_LEN);
+
+}
+
+/**
+ * Called by the start code scanner for each sector about to be written,
+ * adds an entry to the index if it is a NAV pack
+ */
+static bool dvd_copy_index_sector(void *data, uint64_t block, const unsigned char *sector, const uint16_t *offsets, uint32_t codes) {
+
+	struct dvd_copy *dvd_copy = data;
+	pci_t pci;
+	dsi_t dsi;
+	struct dvd_copy_cell *copy_cell = NULL;
+	struct dvd_index_entry dvd_index_entry;
+	uint32_t ix = 0;
+
+	if(!dvd_scan_nav_pack(sector, offsets, codes))
+		return true;
+
+	// libdvdread only reads from the sector
+	navRead_PCI(&pci, (unsigned char *)sector + PCI_START_BYTE);
+	navRead_DSI(&dsi, (unsigned char *)sector + DSI_START_BYTE);
+
+	// Cells are copied in order, so it's almost always the same one
+	// as last time, or the next
+	copy_cell = &dvd_copy->dvd_copy_cells[dvd_copy->cell];
+	for(ix = dvd_copy->cell; ix < dvd_copy->cells && (dsi.dsi_gi.nv_pck_lbn < dvd_copy->dvd_copy_cells[ix].first_sector || dsi.dsi_gi.nv_pck_lbn > dvd_copy->dvd_copy_cells[ix].last_sector); ix++)
+		;
+	if(ix < dvd_copy->cells) {
+		dvd_copy->cell = ix;
+		copy_cell = &dvd_copy->dvd_copy_cells[ix];
+	}
+
+	dvd_index_entry.offset = (dvd_copy->index_blocks + block) * DVD_VIDEO_LB_LEN;
+	dvd_index_entry.msecs = copy_cell->msecs + dvd_time_to_milliseconds(&dsi.dsi_gi.c_eltm);
+	dvd_index_entry.pts = pci.pci_gi.vobu_s_ptm;
+	dvd_index_entry.sector = dsi.dsi_gi.nv_pck_lbn;
+	dvd_index_entry.chapter = copy_cell->chapter;
+	dvd_index_entry.cell = copy_cell->cell;
+
+	if(!dvd_index_add(&dvd_copy->dvd_index, &dvd_index_entry)) {
+		fprintf(stderr, "\n[dvd_copy] Couldn't write index %s\n", dvd_copy->dvd_index.filename);
+		dvd_index_close(&dvd_copy->dvd_index);
+		dvd_copy->index = false;
+		return false;
+	}
+
+	return true;
+
+}
+
+/**
+ * With --index, add an entry for every NAV pack in blocks that are about to
+ * be written. The offsets are counted here, since a direct output hasn't
+ * always written everything it has been given yet.
+ */
+void dvd_copy_index_blocks(struct dvd_copy *dvd_copy, unsigned char *buffer, uint64_t blocks) {
+
+	dvd_scan_blocks(buffer, 0, blocks, dvd_copy_index_sector, dvd_copy);
+
+	dvd_copy->index_blocks += blocks;
+
+}
+
+/**
+ * With --speed, set the read speed of the drive before the copy starts
+ */
+void dvd_copy_speed(struct dvd_copy *dvd_copy, const char *device_filename, bool debug) {
+
+	if(!dvd_copy->speed && !dvd_copy->speed_auto)
+		return;
+
+	if(!dvd_speed_open(&dvd_copy->dvd_speed, device_filename)) {
+		fprintf(stderr, "[dvd_copy] %s isn't a drive, ignoring --speed\n", device_filename);
+		return;
+	}
+
+	if(dvd_copy->speed && !dvd_speed_set(&dvd_copy->dvd_speed, dvd_copy->speed))
+		fprintf(stderr, "[dvd_copy] Couldn't set drive speed to %" PRIu32 "x\n", dvd_copy->speed);
+
+	if(dvd_copy->speed_auto && !dvd_speed_adaptive(&dvd_copy->dvd_speed))
+		fprintf(stderr, "[dvd_copy] Couldn't set drive speed, it won't be adjusted\n");
+
+	if(debug && dvd_copy->dvd_speed.speed)
+		fprintf(stderr, "[dvd_copy] Drive speed: %" PRIu32 "x\n", dvd_copy->dvd_speed.speed);
+
+}
+
+/**
+ * With --raw, read the title VOBs of a title set straight from the drive
+ * with READ(12) instead of through libdvdread. The raw sectors are only
+ * usable if they aren't scrambled, so a sample of them is checked first, and
+ * if the title set has CSS, libdvdread (and libdvdcss) reads it instead.
+ *
+ * Returns false if the title set is read through libdvdread.
+ */
+bool dvd_copy_raw_open(struct dvd_copy *dvd_copy, dvd_reader_t *dvdread_dvd, dvd_file_t *dvdread_vts_file, const char *device_filename, uint16_t vts, bool debug) {
+
+	char udf_filename[32];
+	uint32_t udf_filesize = 0;
+	uint32_t lb_start = 0;
+	unsigned char buffer[DVD_VIDEO_LB_LEN];
+	bool bad = false;
+	ssize_t blocks = 0;
+	uint64_t sample = 0;
+	uint64_t sector = 0;
+
+	dvd_drive_reader_close(&dvd_copy->dvd_drive_reader);
+
+	if(!dvd_copy->raw || dvdread_vts_file == NULL)
+		return false;
+
+	blocks = DVDFileSize(dvdread_vts_file);
+	if(blocks <= 0)
+		return false;
+
+	// The title VOBs are in one run of sectors, starting at the first one
+	memset(udf_filename, '\0', sizeof(udf_filename));
+	snprintf(udf_filename, sizeof(udf_filename), "/VIDEO_TS/VTS_%02" PRIu16 "_1.VOB", vts);
+	lb_start = UDFFindFile(dvdread_dvd, udf_filename, &udf_filesize);
+	if(lb_start == 0) {
+		fprintf(stderr, "[dvd_copy] Couldn't find %s, ignoring --raw\n", udf_filename);
+		return false;
+	}
+
+	if(!dvd_drive_reader_open(&dvd_copy->dvd_drive_reader, device_filename, lb_start, dvd_copy->raw_retries, dvd_copy->raw_timeout)) {
+		fprintf(stderr, "[dvd_copy] %s isn't a drive, ignoring --raw\n", device_filename);
+		dvd_drive_reader_close(&dvd_copy->dvd_drive_reader);
+		return false;
+	}
+
+	for(sample = 0; sample < DVD_SOURCE_SAMPLES && sample < (uint64_t)blocks; sample++) {
+
+		sector = (uint64_t)blocks * sample / DVD_SOURCE_SAMPLES;
+
+		if(dvd_drive_read_blocks(&dvd_copy->dvd_drive_reader, sector, 1, buffer, &bad) || dvd_source_pack_scrambled(buffer)) {
+			if(debug)
+				fprintf(stderr, "[dvd_copy] Title set %" PRIu16 " is scrambled, reading it with libdvdread\n", vts);
+			dvd_drive_reader_close(&dvd_copy->dvd_drive_reader);
+			return false;
+		}
+
+	}
+
+	if(debug)
+		fprintf(stderr, "[dvd_copy] Reading title set %" PRIu16 " with READ(12) from sector %" PRIu32 ", %" PRIu32 " blocks per command\n", vts, lb_start, dvd_copy->dvd_drive_reader.max_blocks);
+
+	return true;
+
+}
+
+/**
+ * Read blocks of the title VOBs, from the drive with --raw, or with
+ * libdvdread
+ */
+uint64_t dvd_copy_read_blocks(struct dvd_copy *dvd_copy, dvd_file_t *dvdread_vts_file, uint64_t offset, uint64_t blocks, unsigned char *buffer, bool *bad) {
+
+	if(dvd_copy->dvd_drive_reader.fd != -1)
+		return dvd_drive_read_blocks(&dvd_copy->dvd_drive_reader, offset, blocks, buffer, bad);
+
+	return dvd_read_blocks(dvdread_vts_file, offset, blocks, buffer, bad);
+
+}
+
+/**
+ * Start timing the copy, and with --readahead, raise the readahead of the
+ * drive for as long as it runs
+ */
+void dvd_copy_readahead_open(struct dvd_copy *dvd_copy, const char *device_filename, bool debug) {
+
+	if(!dvd_readahead_open(&dvd_copy->dvd_readahead, device_filename, dvd_copy->readahead_kbs))
+		fprintf(stderr, "[dvd_copy] Couldn't set readahead of %s\n", device_filename);
+
+	if(debug && dvd_copy->dvd_readahead.sectors)
+		fprintf(stderr, "[dvd_copy] Drive readahead: %lu KiB, was %lu KiB\n", dvd_copy->dvd_readahead.sectors / 2, dvd_copy->dvd_readahead.saved_sectors / 2);
+
+}
+
+/**
+ * With --readahead, find the VOB files of an image or directory, to ask for
+ * each extent before the copy gets to it. The files are read sequentially
+ * whether they are spliced from or read through libdvdread.
+ */
+void dvd_copy_readahead_source(struct dvd_copy *dvd_copy, dvd_reader_t *dvdread_dvd, const char *device_filename, uint16_t vts) {
+
+	uint16_t part = 0;
+
+	if(!dvd_copy->readahead_kbs)
+		return;
+
+	if(!dvd_copy->source)
+		dvd_copy->readahead_source = dvd_source_open(&dvd_copy->dvd_source, dvdread_dvd, device_filename, vts, false);
+
+	if(!dvd_copy->source && !dvd_copy->readahead_source)
+		return;
+
+	for(part = 0; part < dvd_copy->dvd_source.parts; part++)
+		dvd_readahead_sequential(dvd_copy->dvd_source.part[part].fd);
+
+}
+
+/**
+ * Ask for the start of an extent of an image or directory ahead of time,
+ * so the jump to it doesn't wait on the disk. Only as much as the readahead
+ * window is asked for, the kernel's own readahead takes over from there.
+ */
+void dvd_copy_readahead(struct dvd_copy *dvd_copy, struct dvd_extent *extent) {
+
+	uint64_t sector = 0;
+	uint64_t blocks = 0;
+	uint64_t mapped_blocks = 0;
+	int fd = -1;
+	off_t offset = 0;
+
+	if(extent == NULL || !dvd_copy->readahead_kbs || (!dvd_copy->source && !dvd_copy->readahead_source))
+		return;
+
+	sector = extent->first_sector;
+	blocks = extent->last_sector + 1 - extent->first_sector;
+	if(blocks > dvd_copy->readahead_kbs / 2)
+		blocks = dvd_copy->readahead_kbs / 2;
+
+	while(blocks) {
+
+		mapped_blocks = dvd_source_map(&dvd_copy->dvd_source, sector, blocks, &fd, &offset);
+		if(mapped_blocks == 0)
+			return;
+
+		dvd_readahead_file(&dvd_copy->dvd_readahead, fd, offset, mapped_blocks);
+
+		sector += mapped_blocks;
+		blocks -= mapped_blocks;
+
+	}
+
+}
+
+/**
+ * Close the file being written, and start the next one
+ */
+int dvd_copy_split_next(struct dvd_copy *dvd_copy) {
+
+	struct dvd_copy_part *part = NULL;
+
+	if(dvd_copy->part && dvd_output_close(&dvd_copy->dvd_output) == -1)
+		return -1;
+
+	// More blocks than were planned for
+	if(dvd_copy->part == dvd_copy->parts) {
+		dvd_copy->dvd_output.error = EFBIG;
+		return -1;
+	}
+
+	part = &dvd_copy->dvd_copy_parts[dvd_copy->part];
+	dvd_copy_split_filename(dvd_copy->filename, dvd_copy->split_template, dvd_copy->track, part->number);
+
+	if(!dvd_output_open(&dvd_copy->dvd_output, dvd_copy->filename, dvd_copy->direct)) {
+		dvd_copy->dvd_output.error = errno;
+		return -1;
+	}
+
+	if(dvd_output_reserve(&dvd_copy->dvd_output, (off_t)(part->blocks * DVD_VIDEO_LB_LEN)) == -1)
+		return -1;
+
+	dvd_copy->part++;
+	dvd_copy->part_blocks = 0;
+
+	return 0;
+
+}
+
+/**
+ * Fill in a --split filename template, %t is replaced with the track number,
+ * %n with the chapter or cell number, and %% with a percent sign.
+ *
+ * Example:
+ * dvd_track_%t_chapter_%n.mpg -> dvd_track_01_chapter_05.mpg
+ */
+void dvd_copy_split_filename(char *filename, const char *split_template, uint16_t track, uint8_t number) {
+
+	size_t ix = 0;
+	size_t len = 0;
+
+	memset(filename, '\0', PATH_MAX);
+
+	for(ix = 0; split_template[ix] != '\0' && len < PATH_MAX - 4; ix++) {
+
+		if(split_template[ix] != '%') {
+			filename[len++] = split_template[ix];
+			continue;
+		}
+
+		ix++;
+
+		if(split_template[ix] == 't')
+			len += (size_t)snprintf(filename + len, PATH_MAX - len, "%02" PRIu16, track);
+		else if(split_template[ix] == 'n')
+			len += (size_t)snprintf(filename + len, PATH_MAX - len, "%02" PRIu8, number);
+		else if(split_template[ix] == '%')
+			filename[len++] = '%';
+		else if(split_template[ix] == '\0')
+			break;
+
+	}
+
+}
+
+/**
+ * When resuming, pick up the map of sectors the earlier copy couldn't read.
+ * Only the sectors that come before the resume point in the output are
+ * kept, the rest are read again and go back in the map if they still fail.
+ *
+ * Returns false if the map can't be read.
+ */
+bool dvd_copy_bad_sectors_resume(struct dvd_copy *dvd_copy) {
+
+	struct dvd_extents resumed_sectors;
+	struct dvd_extent *extent = NULL;
+	uint64_t sector = 0;
+	uint64_t output_block = 0;
+	uint32_t resumed_ix = 0;
+	uint32_t extent_ix = 0;
+	bool retval = true;
+
+	dvd_extents_init(&resumed_sectors);
+
+	if(!dvd_extents_load(&resumed_sectors, dvd_copy->bad_sectors_filename)) {
+		dvd_extents_free(&resumed_sectors);
+		return false;
+	}
+
+	for(resumed_ix = 0; resumed_ix < resumed_sectors.extents && retval; resumed_ix++) {
+
+		for(sector = resumed_sectors.extent[resumed_ix].first_sector; sector < resumed_sectors.extent[resumed_ix].last_sector + 1 && retval; sector++) {
+
+			// Find where the sector was written in the output
+			output_block = 0;
+			for(extent_ix = 0; extent_ix < dvd_copy->dvd_extents.extents; extent_ix++) {
+				extent = &dvd_copy->dvd_extents.extent[extent_ix];
+				if(sector >= extent->first_sector && sector <= extent->last_sector)
+					break;
+				output_block += extent->last_sector + 1 - extent->first_sector;
+			}
+
+			if(extent_ix == dvd_copy->dvd_extents.extents || output_block + sector - extent->first_sector >= dvd_copy->resume_blocks)
+				continue;
+
+			retval = dvd_extents_add(&dvd_copy->bad_sectors, sector, sector);
+
+		}
+
+	}
+
+	dvd_extents_free(&resumed_sectors);
+
+	return retval;
+
+}
+
+/**
+ * Save the sectors that couldn't be read next to the copy, so they can be
+ * retried later. This is also done when the copy fails, since --resume
+ * picks the map up again. If nothing is left in the map, one left over from
+ * an earlier copy is removed.
+ */
+void dvd_copy_bad_sectors_save(struct dvd_copy *dvd_copy) {
+
+	// Split copies save one map, named after the first file
+	if(dvd_copy->split)
+		dvd_copy_split_filename(dvd_copy->filename, dvd_copy->split_template, dvd_copy->track, dvd_copy->dvd_copy_parts[0].number);
+	snprintf(dvd_copy->bad_sectors_filename, PATH_MAX, "%s.bad", dvd_copy->filename);
+
+	if(dvd_copy->bad_sectors.extents == 0) {
+		unlink(dvd_copy->bad_sectors_filename);
+		return;
+	}
+
+	// Sectors from before the resume point come first
+	dvd_extents_sort(&dvd_copy->bad_sectors);
+
+	if(dvd_extents_save(&dvd_copy->bad_sectors, dvd_copy->bad_sectors_filename))
+		fprintf(stderr, "[dvd_copy] Bad sectors saved to %s\n", dvd_copy->bad_sectors_filename);
+	else
+		fprintf(stderr, "[dvd_copy] Couldn't save bad sectors to %s\n", dvd_copy->bad_sectors_filename);
+
+}
+
+/**
+ * With zero copy, the pipe keeps pointing at a buffer after it has been
+ * written, until the other end reads it. A buffer is handed back to the
+ * reader once the pipe holds no more than what has been written after it.
+ * Buffers are held on to for as long as the reader has another one to fill,
+ * after that, wait on the other end of the pipe.
+ */
+void dvd_copy_release(struct dvd_copy *dvd_copy) {
+
+	struct dvd_ring_slot *slot = NULL;
+	uint32_t held = 0;
+
+	while((held = dvd_ring_held(&dvd_copy->dvd_ring, &slot)) > 0) {
+
+		if((size_t)(dvd_copy->dvd_output.offset - slot->output_offset) >= dvd_output_unread(&dvd_copy->dvd_output)) {
+			dvd_ring_release(&dvd_copy->dvd_ring);
+			continue;
+		}
+
+		if(held < dvd_copy->dvd_ring.slots - 1)
+			break;
+
+		if(!dvd_output_wait(&dvd_copy->dvd_output))
+			break;
+
+	}
+
+}
+
+/**
+ * Writer thread for --tracks: blocks are read in order across the disc, so
+ * each run is handed to every track that plays any of it, at the place in
+ * the track's file where it is played.
+ */
+void *dvd_copy_tracks_writer(void *arg) {
+
+	struct dvd_copy *dvd_copy = arg;
+	struct dvd_ring_slot *slot = NULL;
+	struct dvd_copy_track *copy_track = NULL;
+	struct dvd_extent *extent = NULL;
+	uint16_t track_ix = 0;
+	uint32_t extent_ix = 0;
+	uint64_t track_block = 0;
+	uint64_t first_block = 0;
+	uint64_t last_block = 0;
+	uint64_t block = 0;
+	double mbs_written = 0;
+	double percent_complete = 0;
+
+	while((slot = dvd_ring_read_slot(&dvd_copy->dvd_ring)) != NULL) {
+
+		for(track_ix = 0; track_ix < dvd_copy->tracks && !dvd_copy->write_error; track_ix++) {
+
+			copy_track = &dvd_copy->dvd_copy_tracks[track_ix];
+			if(copy_track->vts != slot->vts)
+				continue;
+
+			// The track's file is its extents one after the other
+			track_block = 0;
+
+			for(extent_ix = 0; extent_ix < copy_track->dvd_extents.extents; extent_ix++) {
+
+				extent = &copy_track->dvd_extents.extent[extent_ix];
+
+				first_block = extent->first_sector > slot->offset ? extent->first_sector : slot->offset;
+				last_block = extent->last_sector < slot->offset + slot->blocks - 1 ? extent->last_sector : slot->offset + slot->blocks - 1;
+
+				if(first_block <= last_block) {
+
+					if(dvd_output_seek(&copy_track->dvd_output, (off_t)((track_block + first_block - extent->first_sector) * DVD_VIDEO_LB_LEN)) < 0 || dvd_output_write_blocks(&copy_track->dvd_output, slot->buffer + (first_block - slot->offset) * DVD_VIDEO_LB_LEN, last_block - first_block + 1, slot->bad_blocks ? slot->bad + (first_block - slot->offset) : NULL) < 0) {
+						dvd_copy->write_error = true;
+						break;
+					}
+
+					for(block = first_block; slot->bad_blocks && block < last_block + 1; block++) {
+						if(slot->bad[block - slot->offset]) {
+							copy_track->bad_blocks++;
+							dvd_extents_add(&copy_track->bad_sectors, block, block);
+						}
+					}
+
+					dvd_copy->bytes_written += (ssize_t)((last_block - first_block + 1) * DVD_VIDEO_LB_LEN);
+
+				}
+
+				track_block += extent->last_sector - extent->first_sector + 1;
+
+			}
+
+		}
+
+		dvd_ring_pop(&dvd_copy->dvd_ring);
+
+		if(dvd_copy->write_error) {
+			dvd_ring_abort(&dvd_copy->dvd_ring);
+			break;
+		}
+
+		mbs_written = ceil(dvd_copy->bytes_written / 1048576.0);
+
+		percent_complete = floor((mbs_written / dvd_copy->filesize_mbs) * 100.0);
+		if(percent_complete >= 100.0)
+			percent_complete = 99.0;
+
+		fprintf(stderr, "Progress: %.0lf/%.0lf MBs (%.0lf%%)\r", mbs_written, dvd_copy->filesize_mbs, percent_complete);
+		fflush(stderr);
+
+	}
+
+	return NULL;
+
+}
+
 int main(int argc, char **argv) {
 
 	bool debug = false;
@@ -75,6 +834,20 @@ int main(int argc, char **argv) {
 	bool p_dvd_copy = true;
 	bool p_dvd_cat = false;
 	bool opt_filename = false;
+	bool opt_resume = false;
+	bool opt_tracks = false;
+	bool opt_angle = false;
+	uint32_t cells_msecs = 0;
+	char index_filename[PATH_MAX];
+	char *speed_end = NULL;
+	uint8_t arg_angle = 1;
+	bool found_stream = false;
+	char stream_id[DVD_AUDIO_STREAM_ID + 1];
+	uint16_t arg_first_track = 1;
+	uint16_t arg_last_track = 1;
+	int retval = 0;
+	struct dvd_copy_part *part = NULL;
+	char journal_description[PATH_MAX];
 	uint16_t arg_track_number = 1;
 	int long_index = 0;
 	int opt = 0;
@@ -89,10 +862,25 @@ int main(int argc, char **argv) {
 
 	struct option long_options[] = {
 
+		{ "angle", required_argument, 0, 'a' },
+		{ "aid", required_argument, 0, 'A' },
+		{ "sid", required_argument, 0, 'S' },
+		{ "read-blocks", required_argument, 0, 'b' },
+		{ "buffers", required_argument, 0, 'B' },
 		{ "chapter", required_argument, 0, 'c' },
 		{ "cells", required_argument, 0, 'd' },
+		{ "direct", no_argument, 0, 'D' },
+		{ "index", no_argument, 0, 'i' },
+		{ "speed", required_argument, 0, 'x' },
+		{ "raw", no_argument, 0, 'R' },
+		{ "raw-retries", required_argument, 0, DVD_COPY_OPT_RAW_RETRIES },
+		{ "raw-timeout", required_argument, 0, DVD_COPY_OPT_RAW_TIMEOUT },
+		{ "readahead", required_argument, 0, DVD_COPY_OPT_READAHEAD },
 		{ "dvd_copy.filename", required_argument, 0, 'o' },
+		{ "resume", no_argument, 0, 'r' },
+		{ "split", required_argument, 0, 's' },
 		{ "track", required_argument, 0, 't' },
+		{ "tracks", required_argument, 0, 'T' },
 		{ "help", no_argument, 0, 'h' },
 		{ "version", no_argument, 0, 'V' },
 		{ "debug", no_argument, 0, 'z' },
@@ -108,14 +896,95 @@ int main(int argc, char **argv) {
 	dvd_copy.blocks = 0;
 	dvd_copy.filesize = 0;
 	dvd_copy.filesize_mbs = 0;
-	dvd_copy.fd = -1;
-	memset(dvd_copy.buffer, '\0', DVD_VIDEO_LB_LEN);
+	dvd_copy.direct = false;
+	dvd_copy.zero_copy = false;
+	dvd_copy.source = false;
+	dvd_copy.read_blocks = DVD_READ_BLOCKS;
+	dvd_copy.bad_blocks = 0;
+	dvd_copy.ring_buffers = DVD_RING_BUFFERS;
+	dvd_copy.journal = false;
+	dvd_copy.resume_blocks = 0;
+	dvd_copy.tracks = 0;
+	dvd_copy.dvd_copy_tracks = NULL;
+	dvd_copy.angle = 0;
+	dvd_copy.demux = false;
+	dvd_copy.index = false;
+	dvd_copy.speed = 0;
+	dvd_copy.speed_auto = false;
+	memset(&dvd_copy.dvd_speed, 0, sizeof(struct dvd_speed));
+	dvd_copy.dvd_speed.fd = -1;
+	dvd_copy.raw = false;
+	dvd_copy.raw_retries = DVD_DRIVE_RETRIES;
+	dvd_copy.raw_timeout = DVD_DRIVE_TIMEOUT;
+	memset(&dvd_copy.dvd_drive_reader, 0, sizeof(struct dvd_drive_reader));
+	dvd_copy.dvd_drive_reader.fd = -1;
+	dvd_copy.readahead_kbs = 0;
+	memset(&dvd_copy.dvd_readahead, 0, sizeof(struct dvd_readahead));
+	dvd_copy.dvd_readahead.fd = -1;
+	dvd_copy.readahead_source = false;
+	dvd_copy.index_blocks = 0;
+	dvd_copy.cells = 0;
+	dvd_copy.cell = 0;
+	dvd_demux_init(&dvd_copy.dvd_demux);
+	dvd_copy.split = DVD_COPY_SPLIT_NONE;
+	dvd_copy.parts = 0;
+	dvd_copy.part = 0;
+	dvd_copy.part_blocks = 0;
+	memset(dvd_copy.split_template, '\0', PATH_MAX);
+	dvd_copy.bytes_written = 0;
+	dvd_copy.write_error = false;
+	dvd_extents_init(&dvd_copy.dvd_extents);
+	dvd_extents_init(&dvd_copy.bad_sectors);
+	memset(dvd_copy.bad_sectors_filename, '\0', PATH_MAX);
 	memset(dvd_copy.filename, '\0', PATH_MAX);
+	memset(dvd_copy.journal_filename, '\0', PATH_MAX);
 
-	while((opt = getopt_long(argc, argv, "c:d:ho:t:Vz", long_options, &long_index )) != -1) {
+	while((opt = getopt_long(argc, argv, "a:A:b:B:c:d:Dhio:rRs:S:t:T:Vx:z", long_options, &long_index )) != -1) {
 
 		switch(opt) {
 
+			case 'a':
+				opt_angle = true;
+				arg_number = strtoul(optarg, NULL, 10);
+				if(arg_number < 1 || arg_number > 9) {
+					fprintf(stderr, "[dvd_copy] Angle must be between 1 and 9\n");
+					return 1;
+				}
+				arg_angle = (uint8_t)arg_number;
+				break;
+
+			case 'A':
+			case 'S':
+				token = strtok(optarg, ",");
+				while(token != NULL) {
+					arg_number = strtoul(token, NULL, 0);
+					if(arg_number > 0xff || (opt == 'A' && !dvd_demux_audio_stream((uint8_t)arg_number)) || (opt == 'S' && !dvd_demux_subtitle_stream((uint8_t)arg_number)) || !dvd_demux_keep(&dvd_copy.dvd_demux, (uint8_t)arg_number)) {
+						fprintf(stderr, "[dvd_copy] Invalid %s stream ID %s\n", opt == 'A' ? "audio" : "subtitle", token);
+						return 1;
+					}
+					token = strtok(NULL, ",");
+				}
+				dvd_copy.demux = true;
+				break;
+
+			case 'b':
+				arg_number = strtoul(optarg, NULL, 10);
+				if(arg_number < 1 || arg_number > DVD_READ_BLOCKS_MAX) {
+					fprintf(stderr, "[dvd_copy] Read blocks must be between 1 and %i\n", DVD_READ_BLOCKS_MAX);
+					return 1;
+				}
+				dvd_copy.read_blocks = (uint64_t)arg_number;
+				break;
+
+			case 'B':
+				arg_number = strtoul(optarg, NULL, 10);
+				if(arg_number < 2 || arg_number > DVD_RING_BUFFERS_MAX) {
+					fprintf(stderr, "[dvd_copy] Buffers must be between 2 and %i\n", DVD_RING_BUFFERS_MAX);
+					return 1;
+				}
+				dvd_copy.ring_buffers = (uint32_t)arg_number;
+				break;
+
 			case 'c':
 				opt_chapter_number = true;
 				token = strtok(optarg, "-");
@@ -201,6 +1070,14 @@ int main(int argc, char **argv) {
 
 				break;
 
+			case 'D':
+				dvd_copy.direct = true;
+				break;
+
+			case 'i':
+				dvd_copy.index = true;
+				break;
+
 			case 'o':
 				if(strlen(optarg) == 1 && strncmp("-", optarg, 1) == 0) {
 					p_dvd_copy = false;
@@ -213,6 +1090,21 @@ int main(int argc, char **argv) {
 				}
 				break;
 
+			case 'r':
+				opt_resume = true;
+				break;
+
+			case 's':
+				if(strcmp(optarg, "chapters") == 0)
+					dvd_copy.split = DVD_COPY_SPLIT_CHAPTERS;
+				else if(strcmp(optarg, "cells") == 0)
+					dvd_copy.split = DVD_COPY_SPLIT_CELLS;
+				else {
+					fprintf(stderr, "[dvd_copy] Split must be either chapters or cells\n");
+					return 1;
+				}
+				break;
+
 			case 't':
 				opt_track_number = true;
 				arg_number = strtoul(optarg, NULL, 10);
@@ -224,10 +1116,74 @@ int main(int argc, char **argv) {
 					arg_track_number = (uint16_t)arg_number;
 				break;
 
+			case 'T':
+				opt_tracks = true;
+				token = strtok(optarg, "-");
+				arg_number = strtoul(token, NULL, 10);
+				if(arg_number < 1 || arg_number > 99) {
+					fprintf(stderr, "[dvd_copy] Track range must be between 1 and 99\n");
+					return 1;
+				}
+				arg_first_track = (uint16_t)arg_number;
+
+				token = strtok(NULL, "-");
+				if(token != NULL)
+					arg_number = strtoul(token, NULL, 10);
+				if(arg_number < arg_first_track || arg_number > 99) {
+					fprintf(stderr, "[dvd_copy] Track range must be between 1 and 99\n");
+					return 1;
+				}
+				arg_last_track = (uint16_t)arg_number;
+				break;
+
+			case 'R':
+				dvd_copy.raw = true;
+				break;
+
+			case DVD_COPY_OPT_RAW_RETRIES:
+				arg_number = strtoul(optarg, NULL, 10);
+				if(arg_number > 100) {
+					fprintf(stderr, "[dvd_copy] Raw retries must be between 0 and 100\n");
+					return 1;
+				}
+				dvd_copy.raw_retries = (uint32_t)arg_number;
+				break;
+
+			case DVD_COPY_OPT_RAW_TIMEOUT:
+				arg_number = strtoul(optarg, NULL, 10);
+				if(arg_number < 1 || arg_number > 600) {
+					fprintf(stderr, "[dvd_copy] Raw timeout must be between 1 and 600 seconds\n");
+					return 1;
+				}
+				dvd_copy.raw_timeout = (uint32_t)arg_number * 1000;
+				break;
+
+			case DVD_COPY_OPT_READAHEAD:
+				arg_number = strtoul(optarg, NULL, 10);
+				if(arg_number < DVD_READAHEAD_KBS_MIN || arg_number > DVD_READAHEAD_KBS_MAX) {
+					fprintf(stderr, "[dvd_copy] Readahead must be between %i and %i KiB\n", DVD_READAHEAD_KBS_MIN, DVD_READAHEAD_KBS_MAX);
+					return 1;
+				}
+				dvd_copy.readahead_kbs = (uint32_t)arg_number;
+				break;
+
 			case 'V':
 				printf("dvd_copy %s\n", PACKAGE_VERSION);
 				return 0;
 
+			case 'x':
+				if(strcmp(optarg, "auto") == 0) {
+					dvd_copy.speed_auto = true;
+					break;
+				}
+				arg_number = strtoul(optarg, &speed_end, 10);
+				if(*speed_end != '\0' || arg_number < DVD_SPEED_MIN || arg_number > DVD_SPEED_MAX) {
+					fprintf(stderr, "[dvd_copy] Speed must be auto, or between %i and %i\n", DVD_SPEED_MIN, DVD_SPEED_MAX);
+					return 1;
+				}
+				dvd_copy.speed = (uint32_t)arg_number;
+				break;
+
 			case 'z':
 				debug = true;
 				break;
@@ -242,9 +1198,25 @@ int main(int argc, char **argv) {
 				printf("\n");
 				printf("Options:\n");
 				printf("  -t, --track <number>     Copy selected track (default: longest)\n");
+				printf("  -T, --tracks <#>[-#]     Copy a range of tracks in one pass to dvd_track_##.mpg\n");
 				printf("  -c, --chapter <#>[-#]    Copy chapter number or range (default: all)\n");
+				printf("  -a, --angle <#>          Copy only the selected angle (default: all)\n");
+				printf("  -A, --aid <id>[,id]      Keep only the selected audio streams (default: all)\n");
+				printf("  -S, --sid <id>[,id]      Keep only the selected subtitle streams (default: all)\n");
 				printf("  -o, --output <filename>  Save to filename (default: dvd_track_##.mpg)\n");
 				printf("      --output -           Write to stdout\n");
+				printf("  -b, --read-blocks <#>    Number of blocks to read at once (default: %i)\n", DVD_READ_BLOCKS);
+				printf("  -B, --buffers <#>        Number of reads to queue for writing (default: %i)\n", DVD_RING_BUFFERS);
+				printf("  -D, --direct             Write to file bypassing the page cache\n");
+				printf("  -r, --resume             Continue an earlier copy that didn't finish\n");
+				printf("  -i, --index              Save a seek index of the copy to <filename>.idx\n");
+				printf("  -x, --speed <#|auto>     Set drive read speed, or lower it on read errors\n");
+				printf("  -R, --raw                Read unencrypted discs from the drive with READ(12)\n");
+				printf("      --raw-retries <#>    Times to retry a bad block with --raw (default: %i)\n", DVD_DRIVE_RETRIES);
+				printf("      --raw-timeout <secs> Time limit of each read with --raw (default: %i)\n", DVD_DRIVE_TIMEOUT / 1000);
+				printf("      --readahead <KiB>    Read further ahead while copying (suggested: %i)\n", DVD_READAHEAD_KBS);
+				printf("  -s, --split <chapters|cells>\n");
+				printf("                           Save each chapter or cell to its own file\n");
 				printf("\n");
 				printf("DVD path can be a device name, a single file, or directory (default: %s)\n", DEFAULT_DVD_DEVICE);
 				if(invalid_opt)
@@ -260,6 +1232,44 @@ int main(int argc, char **argv) {
 
 	}
 
+	// Several tracks are always copied whole, each to its own file
+	if(opt_tracks && (opt_track_number || opt_chapter_number || opt_cell_number || opt_angle || opt_filename || p_dvd_cat || opt_resume || dvd_copy.split || dvd_copy.demux)) {
+		fprintf(stderr, "[dvd_copy] --tracks can't be used with --track, --chapter, --cells, --angle, --output, --resume, --split, --aid or --sid\n");
+		return 1;
+	}
+
+	// Dropping streams changes where everything is in the output, so it
+	// doesn't line up with the sectors of the track anymore
+	if(dvd_copy.demux && (opt_resume || dvd_copy.split)) {
+		fprintf(stderr, "[dvd_copy] --aid and --sid can't be used with --resume or --split\n");
+		return 1;
+	}
+
+	// The index is for a single file, written from start to finish
+	if(dvd_copy.index && (p_dvd_cat || opt_resume || opt_tracks || dvd_copy.split)) {
+		fprintf(stderr, "[dvd_copy] --index can't be used with --output -, --resume, --tracks or --split\n");
+		return 1;
+	}
+
+	// Split files are named after a template, the output filename if there
+	// is one
+	if(dvd_copy.split && (p_dvd_cat || opt_resume)) {
+		fprintf(stderr, "[dvd_copy] --split can't be used with --output - or --resume\n");
+		return 1;
+	}
+
+	if(dvd_copy.split && opt_filename) {
+		if(strstr(dvd_copy.filename, "%n") == NULL) {
+			fprintf(stderr, "[dvd_copy] Output filename must have %%n in it to split, for the chapter or cell number\n");
+			return 1;
+		}
+		strncpy(dvd_copy.split_template, dvd_copy.filename, PATH_MAX - 1);
+	} else if(dvd_copy.split == DVD_COPY_SPLIT_CHAPTERS) {
+		strncpy(dvd_copy.split_template, "dvd_track_%t_chapter_%n.mpg", PATH_MAX - 1);
+	} else if(dvd_copy.split == DVD_COPY_SPLIT_CELLS) {
+		strncpy(dvd_copy.split_template, "dvd_track_%t_cell_%n.mpg", PATH_MAX - 1);
+	}
+
 	// Setting a cell range requires a chapter to be selected; If none is specified, use the first chapter only
 	if(opt_cell_number && !opt_chapter_number) {
 		opt_chapter_number = true;
@@ -288,6 +1298,7 @@ int main(int argc, char **argv) {
 
 	if(vmg_ifo == NULL) {
 		fprintf(stderr, "[dvd_copy] Could not open VMG IFO\n");
+		dvd_vts_stat_reset();
 		DVDClose(dvdread_dvd);
 		return 1;
 	}
@@ -307,6 +1318,7 @@ int main(int argc, char **argv) {
 		fprintf(stderr, "[dvd_copy] DVD has no title IFOs?!\n");
 		fprintf(stderr, "[dvd_copy] Most likely problems reading the disc, quitting\n");
 		ifoClose(vmg_ifo);
+		dvd_vts_stat_reset();
 		DVDClose(dvdread_dvd);
 		return 1;
 	}
@@ -359,6 +1371,7 @@ int main(int argc, char **argv) {
 		fprintf(stderr, "[dvd_copy] Invalid track number %" PRIu16 "\n", arg_track_number);
 		fprintf(stderr, "[dvd_copy] Valid track numbers: 1 to %" PRIu16 "\n", dvd_info.tracks);
 		ifoClose(vmg_ifo);
+		dvd_vts_stat_reset();
 		DVDClose(dvdread_dvd);
 		return 1;
 	} else if(opt_track_number) {
@@ -383,12 +1396,59 @@ int main(int argc, char **argv) {
 
 	}
 
+	// Copy several tracks in one pass across the disc
+	if(opt_tracks) {
+
+		if(arg_last_track > dvd_info.tracks) {
+			fprintf(stderr, "[dvd_copy] Invalid track range %" PRIu16 "-%" PRIu16 "\n", arg_first_track, arg_last_track);
+			fprintf(stderr, "[dvd_copy] Valid track numbers: 1 to %" PRIu16 "\n", dvd_info.tracks);
+			ifoClose(vmg_ifo);
+			dvd_vts_stat_reset();
+			DVDClose(dvdread_dvd);
+			return 1;
+		}
+
+		dvd_copy_speed(&dvd_copy, device_filename, debug);
+		dvd_copy_readahead_open(&dvd_copy, device_filename, debug);
+		retval = dvd_copy_tracks(&dvd_copy, dvdread_dvd, vmg_ifo, vts_ifos, dvd_tracks, arg_first_track, arg_last_track, device_filename, debug);
+		dvd_speed_close(&dvd_copy.dvd_speed);
+		dvd_readahead_close(&dvd_copy.dvd_readahead);
+
+		for(vts = 1; vts < dvd_info.video_title_sets + 1; vts++) {
+			if(vts_ifos[vts])
+				ifoClose(vts_ifos[vts]);
+		}
+
+		ifoClose(vmg_ifo);
+		dvd_vts_stat_reset();
+		DVDClose(dvdread_dvd);
+
+		return retval;
+
+	}
+
 	// Set the track number to rip if none is passed as an argument
 	if(!opt_track_number)
 		dvd_copy.track = dvd_info.longest_track;
 
 	dvd_track = dvd_tracks[dvd_copy.track - 1];
 
+	// Check that the track has the angle
+	if(opt_angle) {
+		dvd_track.dvd_video.angles = dvd_video_angles(vmg_ifo, dvd_copy.track);
+		if(arg_angle > dvd_track.dvd_video.angles) {
+			fprintf(stderr, "[dvd_copy] Invalid angle %" PRIu8 "\n", arg_angle);
+			fprintf(stderr, "[dvd_copy] Valid angles for track %" PRIu16 ": 1 to %" PRIu8 "\n", dvd_copy.track, dvd_track.dvd_video.angles);
+			ifoClose(vmg_ifo);
+			dvd_vts_stat_reset();
+			DVDClose(dvdread_dvd);
+			return 1;
+		}
+		// A track with one angle copies the same with or without it
+		if(dvd_track.dvd_video.angles > 1)
+			dvd_copy.angle = arg_angle;
+	}
+
 	// Set the proper chapter range
 	if(opt_chapter_number) {
 		if(arg_first_chapter > dvd_track.chapters) {
@@ -441,6 +1501,34 @@ int main(int argc, char **argv) {
 	// Open the VTS VOB
 	dvdread_vts_file = DVDOpenFile(dvdread_dvd, vts, DVD_READ_TITLE_VOBS);
 
+	// Check that the streams to keep are in the track
+	for(ix = 0; dvd_copy.demux && ix < 256; ix++) {
+
+		if(!dvd_copy.dvd_demux.keep[ix])
+			continue;
+
+		found_stream = false;
+
+		if(dvd_demux_audio_stream((uint8_t)ix)) {
+			for(track = 0; !found_stream && track < dvd_track.audio_tracks; track++) {
+				if(dvd_audio_stream_id(stream_id, vts_ifo, (uint8_t)track) && strtoul(stream_id, NULL, 0) == ix)
+					found_stream = true;
+			}
+		} else {
+			for(track = 0; !found_stream && track < dvd_track.subtitles; track++) {
+				dvd_subtitle_stream_id(stream_id, (uint8_t)track);
+				if(strtoul(stream_id, NULL, 0) == ix)
+					found_stream = true;
+			}
+		}
+
+		if(!found_stream) {
+			fprintf(stderr, "[dvd_copy] Track %" PRIu16 " has no %s stream 0x%" PRIx16 "\n", dvd_copy.track, dvd_demux_audio_stream((uint8_t)ix) ? "audio" : "subtitle", ix);
+			return 1;
+		}
+
+	}
+
 	if(p_dvd_copy)
 		printf("Track: %*" PRIu16 ", Length: %s, Chapters: %*" PRIu8 ", Cells: %*" PRIu8 ", Audio streams: %*" PRIu8 ", Subpictures: %*" PRIu8 ", Title set: %*" PRIu16 ", Filesize: %.0lf MBs\n", 2, dvd_track.track, dvd_track.length, 2, dvd_track.chapters, 2, dvd_track.cells, 2, dvd_track.audio_tracks, 2, dvd_track.subtitles, 2, vts, dvd_track.filesize_mbs);
 
@@ -467,19 +1555,10 @@ int main(int argc, char **argv) {
 		return 1;
 	}
 
-	if(p_dvd_copy) {
-		dvd_copy.fd = open(dvd_copy.filename, O_WRONLY | O_CREAT | O_APPEND | O_TRUNC, 0644);
-		if(dvd_copy.fd == -1) {
-			fprintf(stderr, "[dvd_copy] Couldn't create file %s\n", dvd_copy.filename);
-			return 1;
-		}
-	} else if(p_dvd_cat) {
-		dvd_copy.fd = 1;
-	}
-
 	struct dvd_chapter dvd_chapter;
+	uint8_t cell_angle = 0;
 
-	// Get limits of copy
+	// Plan the copy, turning the cells into as few runs of sectors as possible
 	for(dvd_chapter.chapter = dvd_copy.first_chapter; dvd_chapter.chapter < dvd_copy.last_chapter + 1; dvd_chapter.chapter++) {
 
 		dvd_chapter.first_cell = dvd_chapter_first_cell(vmg_ifo, vts_ifo, dvd_copy.track, dvd_chapter.chapter);
@@ -490,116 +1569,384 @@ int main(int argc, char **argv) {
 			dvd_copy.last_cell = dvd_chapter.last_cell;
 		}
 
+		// Each file starts where the blocks copied so far end
+		if(dvd_copy.split == DVD_COPY_SPLIT_CHAPTERS && dvd_copy.parts < DVD_COPY_PARTS_MAX) {
+			dvd_copy.dvd_copy_parts[dvd_copy.parts].number = dvd_chapter.chapter;
+			dvd_copy.dvd_copy_parts[dvd_copy.parts].first_block = dvd_copy.dvd_extents.blocks;
+			dvd_copy.parts++;
+		}
+
 		for(dvd_cell.cell = dvd_copy.first_cell; dvd_cell.cell < dvd_copy.last_cell + 1; dvd_cell.cell++) {
-			dvd_cell.blocks = dvd_cell_blocks(vmg_ifo, vts_ifo, dvd_track.track, dvd_cell.cell);
-			dvd_copy.blocks += dvd_cell.blocks;
+
+			// Cells in an angle block are for one angle each, skip the others
+			cell_angle = dvd_copy.angle ? dvd_cell_angle(vmg_ifo, vts_ifo, dvd_track.track, dvd_cell.cell) : 0;
+			if(cell_angle && cell_angle != dvd_copy.angle)
+				continue;
+
+			if(dvd_copy.split == DVD_COPY_SPLIT_CELLS && dvd_copy.parts < DVD_COPY_PARTS_MAX) {
+				dvd_copy.dvd_copy_parts[dvd_copy.parts].number = dvd_cell.cell;
+				dvd_copy.dvd_copy_parts[dvd_copy.parts].first_block = dvd_copy.dvd_extents.blocks;
+				dvd_copy.parts++;
+			}
+
 			dvd_cell.filesize = dvd_cell_filesize(vmg_ifo, vts_ifo, dvd_track.track, dvd_cell.cell);
-			dvd_copy.filesize += dvd_cell.filesize;
+			dvd_cell.first_sector = dvd_cell_first_sector(vmg_ifo, vts_ifo, dvd_track.track, dvd_cell.cell);
+			dvd_cell.last_sector = dvd_cell_last_sector(vmg_ifo, vts_ifo, dvd_track.track, dvd_cell.cell);
+
+			if(dvd_copy.index && dvd_copy.cells < DVD_COPY_PARTS_MAX) {
+				dvd_copy.dvd_copy_cells[dvd_copy.cells].first_sector = dvd_cell.first_sector;
+				dvd_copy.dvd_copy_cells[dvd_copy.cells].last_sector = dvd_cell.last_sector;
+				dvd_copy.dvd_copy_cells[dvd_copy.cells].chapter = dvd_chapter.chapter;
+				dvd_copy.dvd_copy_cells[dvd_copy.cells].cell = dvd_cell.cell;
+				dvd_copy.dvd_copy_cells[dvd_copy.cells].msecs = cells_msecs;
+				dvd_copy.cells++;
+				cells_msecs += dvd_cell_msecs(vmg_ifo, vts_ifo, dvd_track.track, dvd_cell.cell);
+			}
+
+			if(p_dvd_copy)
+				printf("        Chapter: %*" PRIu8 ", Cell: %*" PRIu8 ", Filesize: % 5.0lf MBs\n", 2, dvd_chapter.chapter, 2, dvd_cell.cell, ceil(dvd_cell.filesize / 1048576.0));
+
+			// An interleaved angle cell has the other angles mixed in
+			if(cell_angle && dvd_cell_interleaved(vmg_ifo, vts_ifo, dvd_track.track, dvd_cell.cell)) {
+				switch(dvd_angle_extents(dvdread_vts_file, dvd_cell.first_sector, dvd_cell.last_sector, &dvd_copy.dvd_extents, &dvd_copy.bad_sectors)) {
+					case -1:
+						fprintf(stderr, "[dvd_copy] Couldn't allocate extents\n");
+						return 1;
+					case 0:
+						fprintf(stderr, "[dvd_copy] Couldn't follow the interleaved units of angle %" PRIu8 " in cell %" PRIu8 ", copying the rest of the cell\n", dvd_copy.angle, dvd_cell.cell);
+						break;
+				}
+				continue;
+			}
+
+			if(!dvd_extents_add(&dvd_copy.dvd_extents, dvd_cell.first_sector, dvd_cell.last_sector)) {
+				fprintf(stderr, "[dvd_copy] Couldn't allocate extents\n");
+				return 1;
+			}
+
 		}
 
 	}
 
 	// Get total filesize of copy
+	dvd_copy.blocks = dvd_copy.dvd_extents.blocks;
+	dvd_copy.filesize = dvd_copy.blocks * DVD_VIDEO_LB_LEN;
 	dvd_copy.filesize_mbs = ceil(dvd_copy.filesize / 1048576.0);
 
-	/**
-	 * Integers for numbers of blocks read, copied, counters
-	 */
-	uint64_t cell_sectors = 0;
-	uint64_t cell_block = 0;
-	ssize_t cell_blocks_read = 0;
-	ssize_t total_blocks_read = 0;
-	ssize_t bytes_written = 0;
-	ssize_t total_bytes_written = 0;
+	uint32_t part_ix = 0;
 
-	// Copying DVD track
-	double mbs_written = 0;
-	double percent_complete = 0;
-	for(dvd_chapter.chapter = dvd_copy.first_chapter; dvd_chapter.chapter < dvd_copy.last_chapter + 1; dvd_chapter.chapter++) {
+	for(part_ix = 0; part_ix < dvd_copy.parts; part_ix++) {
+		part = &dvd_copy.dvd_copy_parts[part_ix];
+		part->blocks = (part_ix + 1 < dvd_copy.parts ? dvd_copy.dvd_copy_parts[part_ix + 1].first_block : dvd_copy.blocks) - part->first_block;
+		if(debug) {
+			dvd_copy_split_filename(dvd_copy.filename, dvd_copy.split_template, dvd_copy.track, part->number);
+			fprintf(stderr, "[dvd_copy] Split file: %s, Blocks: %" PRIu64 "\n", dvd_copy.filename, part->blocks);
+		}
+	}
 
-		// Use dvd_copy struct as the first and last cell
-		dvd_chapter.first_cell = dvd_chapter_first_cell(vmg_ifo, vts_ifo, dvd_copy.track, dvd_chapter.chapter);
-		dvd_chapter.last_cell = dvd_chapter_last_cell(vmg_ifo, vts_ifo, dvd_copy.track, dvd_chapter.chapter);
-		dvd_chapter_length(dvd_chapter.length, vmg_ifo, vts_ifo, dvd_copy.track, dvd_chapter.chapter);
+	// Keep a journal of how much of the file is done, so a copy that fails
+	// can be resumed. It is only good for the same selection from the same
+	// disc.
+	snprintf(journal_description, PATH_MAX, "dvd_copy %s track %" PRIu16 " chapters %" PRIu8 "-%" PRIu8 " blocks %" PRIu64, dvd_info.title, dvd_copy.track, dvd_copy.first_chapter, dvd_copy.last_chapter, dvd_copy.blocks);
+	if(opt_cell_number)
+		snprintf(journal_description + strlen(journal_description), PATH_MAX - strlen(journal_description), " cells %" PRIu8 "-%" PRIu8, dvd_copy.first_cell, dvd_copy.last_cell);
+	if(dvd_copy.angle)
+		snprintf(journal_description + strlen(journal_description), PATH_MAX - strlen(journal_description), " angle %" PRIu8, dvd_copy.angle);
+	snprintf(dvd_copy.journal_filename, PATH_MAX, "%s.journal", dvd_copy.filename);
+
+	if(p_dvd_copy && opt_resume) {
+		dvd_copy.resume_blocks = dvd_journal_resume(dvd_copy.journal_filename, journal_description, dvd_copy.filename);
+		// Direct writes have to start on an aligned offset
+		if(dvd_copy.direct)
+			dvd_copy.resume_blocks -= dvd_copy.resume_blocks % (DVD_OUTPUT_ALIGN / DVD_VIDEO_LB_LEN);
+		if(dvd_copy.resume_blocks)
+			printf("Resuming at: %.0lf MBs\n", floor(dvd_copy.resume_blocks * DVD_VIDEO_LB_LEN / 1048576.0));
+		else
+			printf("Nothing to resume, starting from the beginning\n");
+		snprintf(dvd_copy.bad_sectors_filename, PATH_MAX, "%s.bad", dvd_copy.filename);
+		if(dvd_copy.resume_blocks && !dvd_copy_bad_sectors_resume(&dvd_copy))
+			fprintf(stderr, "[dvd_copy] Couldn't read bad sectors from %s\n", dvd_copy.bad_sectors_filename);
+	}
 
-		if(opt_cell_number == false) {
-			dvd_copy.first_cell = dvd_chapter.first_cell;
-			dvd_copy.last_cell = dvd_chapter.last_cell;
+	if(dvd_copy.split) {
+		// Each file is opened by the writer once it gets to it
+		dvd_output_fd(&dvd_copy.dvd_output, -1);
+	} else if(p_dvd_copy && dvd_copy.resume_blocks) {
+		if(!dvd_output_resume(&dvd_copy.dvd_output, dvd_copy.filename, dvd_copy.direct, (off_t)(dvd_copy.resume_blocks * DVD_VIDEO_LB_LEN))) {
+			fprintf(stderr, "[dvd_copy] Couldn't open file %s to resume\n", dvd_copy.filename);
+			return 1;
+		}
+	} else if(p_dvd_copy) {
+		if(!dvd_output_open(&dvd_copy.dvd_output, dvd_copy.filename, dvd_copy.direct)) {
+			fprintf(stderr, "[dvd_copy] Couldn't create file %s\n", dvd_copy.filename);
+			return 1;
 		}
+	} else if(p_dvd_cat) {
+		dvd_output_fd(&dvd_copy.dvd_output, 1);
+	}
 
-		// for(dvd_cell.cell = dvd_chapter.first_cell; dvd_cell.cell < dvd_chapter.last_cell + 1; dvd_cell.cell++) {
-		for(dvd_cell.cell = dvd_copy.first_cell; dvd_cell.cell < dvd_copy.last_cell + 1; dvd_cell.cell++) {
+	// Only regular files can be picked up again later
+	if(p_dvd_copy && dvd_copy.dvd_output.sparse && !dvd_copy.demux) {
+		dvd_copy.journal = dvd_journal_open(&dvd_copy.dvd_journal, dvd_copy.journal_filename, journal_description, dvd_copy.resume_blocks);
+		if(!dvd_copy.journal)
+			fprintf(stderr, "[dvd_copy] Couldn't create journal %s, copy can't be resumed\n", dvd_copy.journal_filename);
+	}
 
-			dvd_cell.blocks = dvd_cell_blocks(vmg_ifo, vts_ifo, dvd_track.track, dvd_cell.cell);
-			dvd_cell.filesize = dvd_cell_filesize(vmg_ifo, vts_ifo, dvd_track.track, dvd_cell.cell);
-			dvd_cell.first_sector = dvd_cell_first_sector(vmg_ifo, vts_ifo, dvd_track.track, dvd_cell.cell);
-			dvd_cell.last_sector = dvd_cell_last_sector(vmg_ifo, vts_ifo, dvd_track.track, dvd_cell.cell);
-			dvd_cell_length(dvd_cell.length, vmg_ifo, vts_ifo, dvd_track.track, dvd_cell.cell);
-			cell_sectors = dvd_cell.last_sector - dvd_cell.first_sector;
+	if(dvd_copy.index) {
+		snprintf(index_filename, PATH_MAX, "%s.idx", dvd_copy.filename);
+		dvd_copy.index = dvd_index_open(&dvd_copy.dvd_index, index_filename);
+		if(!dvd_copy.index)
+			fprintf(stderr, "[dvd_copy] Couldn't create index %s\n", index_filename);
+	}
 
-			if(p_dvd_copy)
-				printf("        Chapter: %*" PRIu8 ", Cell: %*" PRIu8 ", Filesize: % 5.0lf MBs\n", 2, dvd_chapter.chapter, 2, dvd_cell.cell, ceil(dvd_cell.filesize / 1048576.0));
+	dvd_copy.bytes_written = (ssize_t)(dvd_copy.resume_blocks * DVD_VIDEO_LB_LEN);
+
+	// Reserve the space for the copy now, rather than finding out the disk
+	// is full after reading most of the DVD. Without all the streams, the
+	// size isn't known ahead of time.
+	if(p_dvd_copy && !dvd_copy.demux && dvd_output_reserve(&dvd_copy.dvd_output, (off_t)dvd_copy.filesize) == -1) {
+		fprintf(stderr, "[dvd_copy] Couldn't allocate %.0lf MBs for %s: %s\n", dvd_copy.filesize_mbs, dvd_copy.filename, strerror(dvd_copy.dvd_output.error));
+		dvd_output_close(&dvd_copy.dvd_output);
+		if(dvd_copy.journal)
+			dvd_journal_close(&dvd_copy.dvd_journal, !dvd_copy.resume_blocks);
+		if(!dvd_copy.resume_blocks)
+			unlink(dvd_copy.filename);
+		return 1;
+	}
 
-			if(dvd_cell.last_sector > dvd_cell.first_sector)
-				cell_sectors++;
+	uint32_t extent_ix = 0;
 
-			cell_block = dvd_cell.first_sector;
+	if(debug) {
+		for(extent_ix = 0; extent_ix < dvd_copy.dvd_extents.extents; extent_ix++)
+			fprintf(stderr, "[dvd_copy] Extent: %" PRIu32 ", First sector: %" PRIu64 ", Last sector: %" PRIu64 "\n", extent_ix + 1, dvd_copy.dvd_extents.extent[extent_ix].first_sector, dvd_copy.dvd_extents.extent[extent_ix].last_sector);
+	}
 
-			// This is where you would change the boundaries -- are you dumping to a track file (no boundaries) or a VOB (boundaries)
-			while(cell_block < dvd_cell.last_sector + 1) {
+	// Each buffer in the ring holds a full run of blocks
+	if(!dvd_ring_init(&dvd_copy.dvd_ring, dvd_copy.ring_buffers, dvd_copy.read_blocks)) {
+		fprintf(stderr, "[dvd_copy] Couldn't allocate read buffers\n");
+		return 1;
+	}
 
-				cell_blocks_read = DVDReadBlocks(dvdread_vts_file, (size_t)cell_block, 1, dvd_copy.buffer);
-				total_blocks_read += cell_blocks_read;
+	// When writing to a pipe, hand the buffers to it instead of copying them
+	if(p_dvd_cat && dvd_output_zero_copy(&dvd_copy.dvd_output)) {
+		dvd_copy.zero_copy = true;
+		dvd_ring_hold(&dvd_copy.dvd_ring);
+	}
 
-				// Zero out cells that couldn't be read
-				if(cell_blocks_read == -1)
-					memset(dvd_copy.buffer, '\0', DVD_VIDEO_LB_LEN);
+	// If the source is an image or directory that isn't encrypted, the
+	// sectors can be moved from the VOB files directly, either spliced into
+	// a pipe, or cloned / copied by the kernel into a file. Streams can only
+	// be dropped, and NAV packs indexed, from sectors that pass through here.
+	if(!dvd_copy.demux && !dvd_copy.index && (dvd_copy.zero_copy || (p_dvd_copy && !dvd_copy.dvd_output.direct && !(dvd_copy.split && dvd_copy.direct)))) {
 
-				bytes_written = write(dvd_copy.fd, dvd_copy.buffer, DVD_VIDEO_LB_LEN);
-				total_bytes_written += bytes_written;
-				mbs_written = ceil(total_bytes_written / 1048576.0);
+		dvd_copy.source = dvd_source_open(&dvd_copy.dvd_source, dvdread_dvd, device_filename, vts, false);
 
-				if(cell_block == dvd_cell.last_sector)
-					percent_complete = 100;
-				else {
-					percent_complete = floor((mbs_written / dvd_copy.filesize_mbs) * 100.0);
-					if(percent_complete == 100.0)
-						percent_complete = 99.0;
-				}
+		for(extent_ix = 0; dvd_copy.source && extent_ix < dvd_copy.dvd_extents.extents; extent_ix++) {
+			if(dvd_source_scrambled(&dvd_copy.dvd_source, dvd_copy.dvd_extents.extent[extent_ix].first_sector, dvd_copy.dvd_extents.extent[extent_ix].last_sector)) {
+				dvd_source_close(&dvd_copy.dvd_source);
+				dvd_copy.source = false;
+			}
+		}
 
-				// FIXME causes bleeding on previous lines
-				/*
-				if(debug)
-					fprintf(stderr, "Progress: %.0lf/%.0lf MBs (%.0lf%%)  Blocks: %li/%li\r", mbs_written, dvd_copy.filesize_mbs, percent_complete, total_blocks_read, dvd_copy.blocks);
-				else
-				*/
-					fprintf(stderr, "Progress: %.0lf/%.0lf MBs (%.0lf%%)\r", mbs_written, dvd_copy.filesize_mbs, percent_complete);
+		if(debug)
+			fprintf(stderr, "[dvd_copy] Copying from source VOB files: %s\n", dvd_copy.source ? "yes" : "no");
+
+	}
+
+	if(debug && dvd_copy.zero_copy)
+		fprintf(stderr, "[dvd_copy] Zero copy to pipe of %zu bytes\n", dvd_copy.dvd_output.pipe_size);
+
+	/**
+	 * Integers for numbers of blocks read, copied, counters
+	 */
+	struct dvd_extent *extent = NULL;
+	uint64_t extent_block = 0;
+	uint64_t extent_blocks_read = 0;
+	uint64_t bad_block = 0;
+	uint64_t source_blocks = 0;
+	uint64_t total_blocks_read = 0;
+	uint64_t resume_blocks = dvd_copy.resume_blocks;
+	struct dvd_ring_slot *slot = NULL;
+	bool copy_aborted = false;
+
+	dvd_copy_speed(&dvd_copy, device_filename, debug);
+	dvd_copy_raw_open(&dvd_copy, dvdread_dvd, dvdread_vts_file, device_filename, vts, debug);
+	dvd_copy_readahead_open(&dvd_copy, device_filename, debug);
+	dvd_copy_readahead_source(&dvd_copy, dvdread_dvd, device_filename, vts);
+	if(dvd_copy.dvd_extents.extents)
+		dvd_copy_readahead(&dvd_copy, &dvd_copy.dvd_extents.extent[0]);
+
+	// Start the writer, this thread is the reader
+	pthread_t dvd_copy_writer_thread;
+	if(pthread_create(&dvd_copy_writer_thread, NULL, dvd_copy_writer, &dvd_copy) != 0) {
+		fprintf(stderr, "[dvd_copy] Couldn't start writer thread\n");
+		// Don't leave the drive slowed down or its readahead changed
+		dvd_speed_close(&dvd_copy.dvd_speed);
+		dvd_drive_reader_close(&dvd_copy.dvd_drive_reader);
+		dvd_readahead_close(&dvd_copy.dvd_readahead);
+		return 1;
+	}
+
+	// Copying DVD track, streaming whole extents so reads can cross cell boundaries
+	for(extent_ix = 0; extent_ix < dvd_copy.dvd_extents.extents && !copy_aborted; extent_ix++) {
+
+		extent = &dvd_copy.dvd_extents.extent[extent_ix];
+		extent_block = extent->first_sector;
+
+		// Ask for the next extent while this one is read
+		if(extent_ix + 1 < dvd_copy.dvd_extents.extents)
+			dvd_copy_readahead(&dvd_copy, &dvd_copy.dvd_extents.extent[extent_ix + 1]);
+
+		// Skip over what an earlier copy already wrote
+		if(resume_blocks > extent->last_sector + 1 - extent->first_sector) {
+			resume_blocks -= extent->last_sector + 1 - extent->first_sector;
+			continue;
+		}
+		extent_block += resume_blocks;
+		resume_blocks = 0;
 
-				fflush(stderr);
+		while(extent_block < extent->last_sector + 1) {
 
-				cell_block++;
+			// Wait for the writer to hand back a buffer, it only
+			// comes back empty if writing has failed
+			slot = dvd_ring_write_slot(&dvd_copy.dvd_ring);
+			if(slot == NULL) {
+				copy_aborted = true;
+				break;
+			}
+
+			// Read as much of the extent as the buffer holds, and keep
+			// track of any blocks that can't be read
+			extent_blocks_read = extent->last_sector + 1 - extent_block;
+			if(extent_blocks_read > dvd_copy.read_blocks)
+				extent_blocks_read = dvd_copy.read_blocks;
+
+			// Sectors in the source files only need to be pointed at, and
+			// don't need a buffer, so take as much of the extent as possible
+			slot->source_fd = -1;
+			slot->bad_blocks = 0;
+			if(dvd_copy.source)
+				source_blocks = dvd_source_map(&dvd_copy.dvd_source, extent_block, extent->last_sector + 1 - extent_block, &slot->source_fd, &slot->source_offset);
+
+			if(slot->source_fd != -1) {
+				slot->offset = extent_block;
+				slot->blocks = source_blocks;
+				dvd_ring_push(&dvd_copy.dvd_ring);
+				dvd_readahead_update(&dvd_copy.dvd_readahead, source_blocks);
+				total_blocks_read += source_blocks;
+				extent_block += source_blocks;
+				continue;
+			}
 
+			slot->bad_blocks = dvd_copy_read_blocks(&dvd_copy, dvdread_vts_file, extent_block, extent_blocks_read, slot->buffer, slot->bad);
+			dvd_copy.bad_blocks += slot->bad_blocks;
+
+			if(dvd_speed_update(&dvd_copy.dvd_speed, extent_blocks_read, slot->bad_blocks) && debug)
+				fprintf(stderr, "\n[dvd_copy] Drive speed: %" PRIu32 "x\n", dvd_copy.dvd_speed.speed);
+			dvd_readahead_update(&dvd_copy.dvd_readahead, extent_blocks_read);
+			total_blocks_read += extent_blocks_read;
+
+			for(bad_block = 0; slot->bad_blocks && bad_block < extent_blocks_read; bad_block++) {
+				if(slot->bad[bad_block])
+					dvd_extents_add(&dvd_copy.bad_sectors, extent_block + bad_block, extent_block + bad_block);
 			}
 
+			slot->offset = extent_block;
+			slot->blocks = extent_blocks_read;
+			dvd_ring_push(&dvd_copy.dvd_ring);
+
+			extent_block += extent_blocks_read;
+
 		}
 
 	}
 
+	dvd_ring_finish(&dvd_copy.dvd_ring);
+	pthread_join(dvd_copy_writer_thread, NULL);
+
+	// Everything has been read, give the drive its own speed back
+	dvd_speed_close(&dvd_copy.dvd_speed);
+	dvd_drive_reader_close(&dvd_copy.dvd_drive_reader);
+	dvd_readahead_close(&dvd_copy.dvd_readahead);
+
+	// Chapters or cells at the end that have no blocks of their own still
+	// get a file
+	while(dvd_copy.split && !dvd_copy.write_error && dvd_copy.part < dvd_copy.parts) {
+		if(dvd_copy_split_next(&dvd_copy) < 0)
+			dvd_copy.write_error = true;
+	}
+
+	if(dvd_copy.write_error) {
+		fprintf(stderr, "\n[dvd_copy] Couldn't write to %s: %s\n", p_dvd_cat ? "stdout" : dvd_copy.filename, strerror(dvd_copy.dvd_output.error));
+		if(dvd_copy.journal) {
+			dvd_journal_close(&dvd_copy.dvd_journal, false);
+			fprintf(stderr, "[dvd_copy] Use --resume to continue the copy\n");
+		}
+		if(p_dvd_copy)
+			dvd_copy_bad_sectors_save(&dvd_copy);
+		return 1;
+	}
+
 	fprintf(stderr, "Progress: %.0lf/%.0lf MBs (100%%)\r", dvd_copy.filesize_mbs, dvd_copy.filesize_mbs);
 	fflush(stderr);
 
-	close(dvd_copy.fd);
+	if(dvd_output_close(&dvd_copy.dvd_output) == -1) {
+		fprintf(stderr, "\n[dvd_copy] Couldn't write to %s: %s\n", dvd_copy.filename, strerror(dvd_copy.dvd_output.error));
+		if(dvd_copy.journal) {
+			dvd_journal_close(&dvd_copy.dvd_journal, false);
+			fprintf(stderr, "[dvd_copy] Use --resume to continue the copy\n");
+		}
+		if(p_dvd_copy)
+			dvd_copy_bad_sectors_save(&dvd_copy);
+		return 1;
+	}
+
+	// The copy is complete, the journal isn't needed anymore
+	if(dvd_copy.journal)
+		dvd_journal_close(&dvd_copy.dvd_journal, true);
 
 	DVDCloseFile(dvdread_vts_file);
 
 	fprintf(stderr, "\n");
 
+	if(dvd_copy.index && !dvd_index_close(&dvd_copy.dvd_index))
+		fprintf(stderr, "[dvd_copy] Couldn't write index %s\n", dvd_copy.dvd_index.filename);
+	else if(dvd_copy.index && debug)
+		fprintf(stderr, "[dvd_copy] Index entries: %" PRIu32 "\n", dvd_copy.dvd_index.entries);
+
+	if(debug) {
+		fprintf(stderr, "[dvd_copy] Blocks read: %" PRIu64 "\n", total_blocks_read);
+		fprintf(stderr, "[dvd_copy] Read %.0lf MBs in %.2lf seconds: %.1lf MB/s\n", dvd_copy.dvd_readahead.blocks * DVD_VIDEO_LB_LEN / 1048576.0, dvd_readahead_seconds(&dvd_copy.dvd_readahead), dvd_readahead_mbs(&dvd_copy.dvd_readahead));
+		if(dvd_copy.dvd_readahead.hints)
+			fprintf(stderr, "[dvd_copy] Readahead requests: %" PRIu64 "\n", dvd_copy.dvd_readahead.hints);
+		fprintf(stderr, "[dvd_copy] Reader stalled waiting on writer: %.2lf seconds\n", dvd_copy.dvd_ring.reader_stall_nsecs / 1000000000.0);
+		fprintf(stderr, "[dvd_copy] Writer stalled waiting on reader: %.2lf seconds\n", dvd_copy.dvd_ring.writer_stall_nsecs / 1000000000.0);
+		if(dvd_copy.demux)
+			fprintf(stderr, "[dvd_copy] Packs: %" PRIu64 ", Dropped: %" PRIu64 ", Packets padded: %" PRIu64 "\n", dvd_copy.dvd_demux.packs, dvd_copy.dvd_demux.dropped_packs, dvd_copy.dvd_demux.padded_packets);
+	}
+
+	dvd_ring_free(&dvd_copy.dvd_ring);
+
+	if(dvd_copy.source || dvd_copy.readahead_source)
+		dvd_source_close(&dvd_copy.dvd_source);
+	dvd_extents_free(&dvd_copy.dvd_extents);
+
+	if(dvd_copy.bad_blocks)
+		fprintf(stderr, "[dvd_copy] Blocks that couldn't be read: %" PRIu64 "\n", dvd_copy.bad_blocks);
+
+	if(p_dvd_copy)
+		dvd_copy_bad_sectors_save(&dvd_copy);
+
+	dvd_extents_free(&dvd_copy.bad_sectors);
+
 	if(vts_ifo)
 		ifoClose(vts_ifo);
 
 	if(vmg_ifo)
 		ifoClose(vmg_ifo);
 
+	dvd_vts_stat_reset();
+
 	if(dvdread_dvd)
 		DVDClose(dvdread_dvd);
 
@@ -607,6 +1954,290 @@ int main(int argc, char **argv) {
 
 }
 
+/**
+ * Copy a range of tracks, each to its own file, reading the disc just once.
+ *
+ * The extents of all the tracks in a title set are combined, put in order
+ * and merged (see dvd_extents_sort()), so the drive reads straight across
+ * the title set without ever seeking back, and sectors that several tracks
+ * share (the episodes and the "play all" track of a TV disc, for example)
+ * are only read once. Title sets are read in order as well.
+ *
+ * Since the tracks are written out of order, the outputs have to be regular
+ * files, and are written without O_DIRECT.
+ */
+int dvd_copy_tracks(struct dvd_copy *dvd_copy, dvd_reader_t *dvdread_dvd, ifo_handle_t *vmg_ifo, ifo_handle_t **vts_ifos, struct dvd_track *dvd_tracks, uint16_t first_track, uint16_t last_track, const char *device_filename, bool debug) {
+
+	struct dvd_copy_track *copy_track = NULL;
+	struct dvd_track *dvd_track = NULL;
+	struct dvd_extents vts_extents;
+	struct dvd_extent *extent = NULL;
+	struct dvd_ring_slot *slot = NULL;
+	dvd_file_t *dvdread_vts_file = NULL;
+	pthread_t dvd_copy_writer_thread;
+	uint16_t track_ix = 0;
+	uint16_t vts = 0;
+	uint16_t last_vts = 0;
+	uint8_t cell = 0;
+	uint32_t extent_ix = 0;
+	uint64_t extent_block = 0;
+	uint64_t extent_blocks_read = 0;
+	uint64_t total_blocks_read = 0;
+	uint16_t tracks_opened = 0;
+	bool ring = false;
+	bool copy_started = false;
+	bool copy_aborted = false;
+	int retval = 0;
+
+	if(dvd_copy->direct) {
+		fprintf(stderr, "[dvd_copy] Tracks are written out of order, not using direct output\n");
+		dvd_copy->direct = false;
+	}
+
+	dvd_copy->tracks = last_track - first_track + 1;
+	dvd_copy->dvd_copy_tracks = calloc(dvd_copy->tracks, sizeof(struct dvd_copy_track));
+	if(dvd_copy->dvd_copy_tracks == NULL) {
+		fprintf(stderr, "[dvd_copy] Couldn't allocate tracks\n");
+		return 1;
+	}
+
+	// Plan each track, the same as copying it on its own
+	for(track_ix = 0; track_ix < dvd_copy->tracks; track_ix++) {
+
+		copy_track = &dvd_copy->dvd_copy_tracks[track_ix];
+		dvd_track = &dvd_tracks[first_track + track_ix - 1];
+
+		copy_track->track = dvd_track->track;
+		copy_track->vts = dvd_track->vts;
+		dvd_extents_init(&copy_track->dvd_extents);
+		dvd_extents_init(&copy_track->bad_sectors);
+		snprintf(copy_track->filename, PATH_MAX, "dvd_track_%02" PRIu16 ".mpg", dvd_track->track);
+
+		printf("Track: %*" PRIu16 ", Length: %s, Chapters: %*" PRIu8 ", Cells: %*" PRIu8 ", Title set: %*" PRIu16 ", Filesize: %.0lf MBs\n", 2, dvd_track->track, dvd_track->length, 2, dvd_track->chapters, 2, dvd_track->cells, 2, dvd_track->vts, dvd_track->filesize_mbs);
+
+		// Tracks that can't be played are left out, the same as in a
+		// single track copy
+		if(vts_ifos[dvd_track->vts] == NULL || dvd_track->msecs == 0 || dvd_track->chapters == 0 || dvd_track->cells == 0) {
+			printf("        Error: track is invalid, skipping\n");
+			copy_track->vts = 0;
+			continue;
+		}
+
+		for(cell = 1; cell < dvd_track->cells + 1; cell++) {
+			if(!dvd_extents_add(&copy_track->dvd_extents, dvd_cell_first_sector(vmg_ifo, vts_ifos[dvd_track->vts], dvd_track->track, cell), dvd_cell_last_sector(vmg_ifo, vts_ifos[dvd_track->vts], dvd_track->track, cell))) {
+				fprintf(stderr, "[dvd_copy] Couldn't allocate extents\n");
+				retval = 1;
+				goto cleanup;
+			}
+		}
+
+		if(!dvd_output_open(&copy_track->dvd_output, copy_track->filename, false)) {
+			fprintf(stderr, "[dvd_copy] Couldn't create file %s\n", copy_track->filename);
+			retval = 1;
+			goto cleanup;
+		}
+
+		tracks_opened = track_ix + 1;
+
+		if(dvd_output_reserve(&copy_track->dvd_output, (off_t)(copy_track->dvd_extents.blocks * DVD_VIDEO_LB_LEN)) == -1) {
+			fprintf(stderr, "[dvd_copy] Couldn't allocate %.0lf MBs for %s: %s\n", ceil(copy_track->dvd_extents.blocks * DVD_VIDEO_LB_LEN / 1048576.0), copy_track->filename, strerror(copy_track->dvd_output.error));
+			retval = 1;
+			goto cleanup;
+		}
+
+		dvd_copy->blocks += copy_track->dvd_extents.blocks;
+
+		if(copy_track->vts > last_vts)
+			last_vts = copy_track->vts;
+
+	}
+
+	dvd_copy->filesize = dvd_copy->blocks * DVD_VIDEO_LB_LEN;
+	dvd_copy->filesize_mbs = ceil(dvd_copy->filesize / 1048576.0);
+
+	if(!dvd_ring_init(&dvd_copy->dvd_ring, dvd_copy->ring_buffers, dvd_copy->read_blocks)) {
+		fprintf(stderr, "[dvd_copy] Couldn't allocate read buffers\n");
+		retval = 1;
+		goto cleanup;
+	}
+
+	ring = true;
+
+	if(pthread_create(&dvd_copy_writer_thread, NULL, dvd_copy_tracks_writer, dvd_copy) != 0) {
+		fprintf(stderr, "[dvd_copy] Couldn't start writer thread\n");
+		retval = 1;
+		goto cleanup;
+	}
+
+	copy_started = true;
+
+	for(vts = 1; vts < last_vts + 1 && !copy_aborted; vts++) {
+
+		// Every sector of the title set that any of the tracks need
+		dvd_extents_init(&vts_extents);
+
+		for(track_ix = 0; track_ix < dvd_copy->tracks; track_ix++) {
+
+			copy_track = &dvd_copy->dvd_copy_tracks[track_ix];
+			if(copy_track->vts != vts)
+				continue;
+
+			for(extent_ix = 0; extent_ix < copy_track->dvd_extents.extents; extent_ix++) {
+				if(!dvd_extents_add(&vts_extents, copy_track->dvd_extents.extent[extent_ix].first_sector, copy_track->dvd_extents.extent[extent_ix].last_sector)) {
+					fprintf(stderr, "[dvd_copy] Couldn't allocate extents\n");
+					copy_aborted = true;
+					break;
+				}
+			}
+
+		}
+
+		dvd_extents_sort(&vts_extents);
+
+		if(vts_extents.extents == 0 || copy_aborted) {
+			dvd_extents_free(&vts_extents);
+			continue;
+		}
+
+		if(debug) {
+			for(extent_ix = 0; extent_ix < vts_extents.extents; extent_ix++)
+				fprintf(stderr, "[dvd_copy] Title set: %" PRIu16 ", Extent: %" PRIu32 ", First sector: %" PRIu64 ", Last sector: %" PRIu64 "\n", vts, extent_ix + 1, vts_extents.extent[extent_ix].first_sector, vts_extents.extent[extent_ix].last_sector);
+		}
+
+		dvdread_vts_file = DVDOpenFile(dvdread_dvd, vts, DVD_READ_TITLE_VOBS);
+		if(dvdread_vts_file == NULL) {
+			fprintf(stderr, "[dvd_copy] Couldn't open title set %" PRIu16 "\n", vts);
+			dvd_extents_free(&vts_extents);
+			copy_aborted = true;
+			break;
+		}
+
+		dvd_copy_raw_open(dvd_copy, dvdread_dvd, dvdread_vts_file, device_filename, vts, debug);
+		dvd_copy_readahead_source(dvd_copy, dvdread_dvd, device_filename, vts);
+		dvd_copy_readahead(dvd_copy, &vts_extents.extent[0]);
+
+		for(extent_ix = 0; extent_ix < vts_extents.extents && !copy_aborted; extent_ix++) {
+
+			extent = &vts_extents.extent[extent_ix];
+			extent_block = extent->first_sector;
+
+			if(extent_ix + 1 < vts_extents.extents)
+				dvd_copy_readahead(dvd_copy, &vts_extents.extent[extent_ix + 1]);
+
+			while(extent_block < extent->last_sector + 1) {
+
+				slot = dvd_ring_write_slot(&dvd_copy->dvd_ring);
+				if(slot == NULL) {
+					copy_aborted = true;
+					break;
+				}
+
+				extent_blocks_read = extent->last_sector + 1 - extent_block;
+				if(extent_blocks_read > dvd_copy->read_blocks)
+					extent_blocks_read = dvd_copy->read_blocks;
+
+				slot->source_fd = -1;
+				slot->vts = vts;
+				slot->bad_blocks = dvd_copy_read_blocks(dvd_copy, dvdread_vts_file, extent_block, extent_blocks_read, slot->buffer, slot->bad);
+				if(dvd_speed_update(&dvd_copy->dvd_speed, extent_blocks_read, slot->bad_blocks) && debug)
+					fprintf(stderr, "\n[dvd_copy] Drive speed: %" PRIu32 "x\n", dvd_copy->dvd_speed.speed);
+				slot->offset = extent_block;
+				slot->blocks = extent_blocks_read;
+				dvd_ring_push(&dvd_copy->dvd_ring);
+
+				dvd_copy->bad_blocks += slot->bad_blocks;
+				dvd_readahead_update(&dvd_copy->dvd_readahead, extent_blocks_read);
+				total_blocks_read += extent_blocks_read;
+				extent_block += extent_blocks_read;
+
+			}
+
+		}
+
+		DVDCloseFile(dvdread_vts_file);
+		dvd_drive_reader_close(&dvd_copy->dvd_drive_reader);
+		if(dvd_copy->readahead_source)
+			dvd_source_close(&dvd_copy->dvd_source);
+		dvd_copy->readahead_source = false;
+		dvd_extents_free(&vts_extents);
+
+	}
+
+	dvd_ring_finish(&dvd_copy->dvd_ring);
+	pthread_join(dvd_copy_writer_thread, NULL);
+
+	if(!copy_aborted) {
+		fprintf(stderr, "Progress: %.0lf/%.0lf MBs (100%%)\r", dvd_copy->filesize_mbs, dvd_copy->filesize_mbs);
+		fflush(stderr);
+	}
+
+	fprintf(stderr, "\n");
+
+	if(debug) {
+		fprintf(stderr, "[dvd_copy] Blocks read: %" PRIu64 ", Blocks written: %" PRIu64 "\n", total_blocks_read, dvd_copy->blocks);
+		fprintf(stderr, "[dvd_copy] Read %.0lf MBs in %.2lf seconds: %.1lf MB/s\n", dvd_copy->dvd_readahead.blocks * DVD_VIDEO_LB_LEN / 1048576.0, dvd_readahead_seconds(&dvd_copy->dvd_readahead), dvd_readahead_mbs(&dvd_copy->dvd_readahead));
+		if(dvd_copy->dvd_readahead.hints)
+			fprintf(stderr, "[dvd_copy] Readahead requests: %" PRIu64 "\n", dvd_copy->dvd_readahead.hints);
+		fprintf(stderr, "[dvd_copy] Reader stalled waiting on writer: %.2lf seconds\n", dvd_copy->dvd_ring.reader_stall_nsecs / 1000000000.0);
+		fprintf(stderr, "[dvd_copy] Writer stalled waiting on reader: %.2lf seconds\n", dvd_copy->dvd_ring.writer_stall_nsecs / 1000000000.0);
+	}
+
+	cleanup:
+
+	for(track_ix = 0; track_ix < dvd_copy->tracks; track_ix++) {
+
+		copy_track = &dvd_copy->dvd_copy_tracks[track_ix];
+
+		if(copy_track->vts == 0 || track_ix >= tracks_opened) {
+			dvd_extents_free(&copy_track->dvd_extents);
+			dvd_extents_free(&copy_track->bad_sectors);
+			continue;
+		}
+
+		// Until the copy starts, nothing has been written, so every output
+		// that was created (and already takes up its full size) is removed
+		if(!copy_started) {
+			dvd_output_close(&copy_track->dvd_output);
+			unlink(copy_track->filename);
+			dvd_extents_free(&copy_track->dvd_extents);
+			dvd_extents_free(&copy_track->bad_sectors);
+			continue;
+		}
+
+		// The last write may not have been at the end of the file
+		dvd_output_seek(&copy_track->dvd_output, (off_t)(copy_track->dvd_extents.blocks * DVD_VIDEO_LB_LEN));
+
+		if(dvd_output_close(&copy_track->dvd_output) == -1) {
+			fprintf(stderr, "[dvd_copy] Couldn't write to %s: %s\n", copy_track->filename, strerror(copy_track->dvd_output.error));
+			retval = 1;
+		}
+
+		if(copy_track->bad_blocks) {
+			fprintf(stderr, "[dvd_copy] Blocks that couldn't be read in %s: %" PRIu64 "\n", copy_track->filename, copy_track->bad_blocks);
+			snprintf(dvd_copy->bad_sectors_filename, PATH_MAX, "%s.bad", copy_track->filename);
+			if(dvd_extents_save(&copy_track->bad_sectors, dvd_copy->bad_sectors_filename))
+				fprintf(stderr, "[dvd_copy] Bad sectors saved to %s\n", dvd_copy->bad_sectors_filename);
+			else
+				fprintf(stderr, "[dvd_copy] Couldn't save bad sectors to %s\n", dvd_copy->bad_sectors_filename);
+		}
+
+		dvd_extents_free(&copy_track->dvd_extents);
+		dvd_extents_free(&copy_track->bad_sectors);
+
+	}
+
+	if(ring)
+		dvd_ring_free(&dvd_copy->dvd_ring);
+	free(dvd_copy->dvd_copy_tracks);
+	dvd_copy->dvd_copy_tracks = NULL;
+
+	if(copy_aborted)
+		retval = 1;
+
+	return retval;
+
+}
+
 void dvd_track_info(struct dvd_track *dvd_track, uint16_t track_number, ifo_handle_t *vmg_ifo, ifo_handle_t *vts_ifo) {
 
 	dvd_track->track = track_number;
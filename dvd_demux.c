@@ -0,0 +1,157 @@
+#include "dvd_demux.h"
+
+/**
+ * Functions used to drop streams from a VOB as it is copied
+ */
+
+void dvd_demux_init(struct dvd_demux *dvd_demux) {
+
+	memset(dvd_demux, 0, sizeof(struct dvd_demux));
+
+}
+
+bool dvd_demux_audio_stream(uint8_t stream_id) {
+
+	if(stream_id >= 0x80 && stream_id <= 0x8f)
+		return true;
+
+	if(stream_id >= 0xa0 && stream_id <= 0xa7)
+		return true;
+
+	if(stream_id >= 0xc0 && stream_id <= 0xc7)
+		return true;
+
+	return false;
+
+}
+
+bool dvd_demux_subtitle_stream(uint8_t stream_id) {
+
+	if(stream_id >= 0x20 && stream_id <= 0x3f)
+		return true;
+
+	return false;
+
+}
+
+bool dvd_demux_keep(struct dvd_demux *dvd_demux, uint8_t stream_id) {
+
+	if(dvd_demux_audio_stream(stream_id))
+		dvd_demux->audio = true;
+	else if(dvd_demux_subtitle_stream(stream_id))
+		dvd_demux->subtitles = true;
+	else
+		return false;
+
+	dvd_demux->keep[stream_id] = true;
+
+	return true;
+
+}
+
+/**
+ * Check if a PES packet is for a stream that isn't selected
+ */
+static bool dvd_demux_drop(struct dvd_demux *dvd_demux, const unsigned char *packet, size_t packet_bytes) {
+
+	uint8_t stream_id = packet[3];
+	size_t header_bytes = 0;
+
+	// Private stream 1 has the substream ID right after the MPEG-2 PES
+	// header
+	if(stream_id == DVD_DEMUX_PRIVATE_STREAM_1) {
+		if(packet_bytes < 9 || (packet[6] & 0xc0) != 0x80)
+			return false;
+		header_bytes = 9 + packet[8];
+		if(header_bytes + 1 > packet_bytes)
+			return false;
+		stream_id = packet[header_bytes];
+	} else if(stream_id < 0xc0 || stream_id > 0xdf) {
+		return false;
+	}
+
+	if(dvd_demux->audio && dvd_demux_audio_stream(stream_id))
+		return !dvd_demux->keep[stream_id];
+
+	if(dvd_demux->subtitles && dvd_demux_subtitle_stream(stream_id))
+		return !dvd_demux->keep[stream_id];
+
+	return false;
+
+}
+
+bool dvd_demux_pack(struct dvd_demux *dvd_demux, unsigned char *pack) {
+
+	size_t ix = 0;
+	size_t packet_bytes = 0;
+	uint32_t packets = 0;
+	uint32_t dropped = 0;
+	uint32_t padding = 0;
+
+	// Not a pack, or an MPEG-1 one, which a DVD never has
+	if(pack[0] != 0 || pack[1] != 0 || pack[2] != 1 || pack[3] != 0xba || (pack[4] & 0xc0) != 0x40)
+		return true;
+
+	dvd_demux->packs++;
+
+	// MPEG-2 pack header, plus stuffing
+	ix = 14 + (pack[13] & 0x07);
+
+	while(ix + 6 <= DVD_VIDEO_LB_LEN) {
+
+		if(pack[ix] != 0 || pack[ix + 1] != 0 || pack[ix + 2] != 1 || pack[ix + 3] == DVD_DEMUX_PROGRAM_END)
+			break;
+
+		packet_bytes = 6 + ((size_t)pack[ix + 4] << 8 | pack[ix + 5]);
+		if(ix + packet_bytes > DVD_VIDEO_LB_LEN)
+			break;
+
+		packets++;
+
+		if(dvd_demux_drop(dvd_demux, &pack[ix], packet_bytes)) {
+			pack[ix + 3] = DVD_DEMUX_PADDING_STREAM;
+			memset(&pack[ix + 6], 0xff, packet_bytes - 6);
+			dropped++;
+		} else if(pack[ix + 3] == DVD_DEMUX_PADDING_STREAM) {
+			// Padding on its own doesn't make a pack worth keeping
+			padding++;
+		}
+
+		ix += packet_bytes;
+
+	}
+
+	if(packets && dropped + padding == packets) {
+		dvd_demux->dropped_packs++;
+		return false;
+	}
+
+	dvd_demux->padded_packets += dropped;
+
+	return true;
+
+}
+
+uint64_t dvd_demux_blocks(struct dvd_demux *dvd_demux, unsigned char *buffer, bool *bad, uint64_t blocks) {
+
+	uint64_t block = 0;
+	uint64_t kept = 0;
+
+	for(block = 0; block < blocks; block++) {
+
+		if(!dvd_demux_pack(dvd_demux, buffer + block * DVD_VIDEO_LB_LEN))
+			continue;
+
+		if(kept != block) {
+			memmove(buffer + kept * DVD_VIDEO_LB_LEN, buffer + block * DVD_VIDEO_LB_LEN, DVD_VIDEO_LB_LEN);
+			if(bad != NULL)
+				bad[kept] = bad[block];
+		}
+
+		kept++;
+
+	}
+
+	return kept;
+
+}
@@ -0,0 +1,88 @@
+#ifndef DVD_INFO_DEMUX_H
+#define DVD_INFO_DEMUX_H
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef DVD_VIDEO_LB_LEN
+#define DVD_VIDEO_LB_LEN 2048
+#endif
+
+// PES stream IDs that matter here
+#define DVD_DEMUX_PRIVATE_STREAM_1 0xbd
+#define DVD_DEMUX_PADDING_STREAM 0xbe
+#define DVD_DEMUX_PROGRAM_END 0xb9
+
+/**
+ * Drop audio and subtitle streams from the program stream of a track, while
+ * it is being copied.
+ *
+ * A VOB is a series of 2048 byte packs, one per sector, and each pack holds
+ * a pack header and one or more PES packets. MPEG audio has a PES stream ID
+ * of its own (0xc0 to 0xc7), but AC3, DTS, LPCM and subtitles all share
+ * private stream 1 (0xbd), with a substream ID in the first byte of the
+ * payload. Both are the same numbers that dvd_audio_stream_id() and
+ * dvd_subtitle_stream_id() report, and that are used here to pick the
+ * streams to keep.
+ *
+ * Audio and subtitles are only filtered if at least one stream of that kind
+ * is selected. Video, navigation packets, and anything that isn't a pack
+ * (a sector that couldn't be read) are always kept.
+ *
+ * A pack with nothing left in it is dropped. In a pack that still has a
+ * stream that is kept, the packets that aren't are turned into padding
+ * packets of the same length, so the pack stays a full sector and its pack
+ * header is still correct. The output is a valid program stream, and a whole number
+ * of sectors, but the sector addresses in the navigation packets no longer
+ * point to the right places.
+ *
+ * Example:
+ * Streams: 0xe0 video, 0x80 AC3 English, 0x81 AC3 French, 0x20 subtitles English,
+ * 0x21 subtitles French
+ * Keep: --aid 0x80 --sid 0x20
+ *
+ * [pack 0xbf 0xbf] [pack 0xe0] [pack 0xbd/0x81] [pack 0xbd/0x80] [pack 0xbd/0x21]
+ * [pack 0xbf 0xbf] [pack 0xe0] [pack 0xbd/0x80]
+ */
+
+struct dvd_demux {
+	bool keep[256];
+	bool audio;
+	bool subtitles;
+	uint64_t packs;
+	uint64_t dropped_packs;
+	uint64_t padded_packets;
+};
+
+void dvd_demux_init(struct dvd_demux *dvd_demux);
+
+/**
+ * Stream IDs for audio are 0x80 to 0x8f (AC3 and DTS), 0xa0 to 0xa7 (LPCM)
+ * and 0xc0 to 0xc7 (MPEG), and for subtitles 0x20 to 0x3f.
+ */
+bool dvd_demux_audio_stream(uint8_t stream_id);
+bool dvd_demux_subtitle_stream(uint8_t stream_id);
+
+/**
+ * Select an audio or subtitle stream to keep. Returns false if the stream ID
+ * isn't either.
+ */
+bool dvd_demux_keep(struct dvd_demux *dvd_demux, uint8_t stream_id);
+
+/**
+ * Filter one pack in place. Returns false if nothing in it is kept, and the
+ * pack should be dropped.
+ */
+bool dvd_demux_pack(struct dvd_demux *dvd_demux, unsigned char *pack);
+
+/**
+ * Filter a buffer of blocks in place, moving the packs that are kept to the
+ * front, along with their entries in bad (which can be NULL). Returns the
+ * number of blocks kept.
+ */
+uint64_t dvd_demux_blocks(struct dvd_demux *dvd_demux, unsigned char *buffer, bool *bad, uint64_t blocks);
+
+#endif
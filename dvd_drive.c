@@ -135,4 +135,219 @@ void dvd_drive_display_status(const char *device_filename) {
 
 }
 
+/**
+ * Send an MMC command to the drive with SG_IO, the timeout is in
+ * milliseconds. Returns false if the command or its transfer failed.
+ */
+bool dvd_drive_command(int fd, unsigned char *cdb, unsigned char cdb_len, unsigned char *data, unsigned int data_len, int direction, unsigned int timeout) {
+
+	sg_io_hdr_t io_hdr;
+	unsigned char sense[32];
+
+	memset(&io_hdr, 0, sizeof(sg_io_hdr_t));
+	memset(sense, 0, sizeof(sense));
+
+	io_hdr.interface_id = 'S';
+	io_hdr.cmd_len = cdb_len;
+	io_hdr.cmdp = cdb;
+	io_hdr.mx_sb_len = sizeof(sense);
+	io_hdr.sbp = sense;
+	io_hdr.dxfer_direction = direction;
+	io_hdr.dxfer_len = data_len;
+	io_hdr.dxferp = data;
+	io_hdr.timeout = timeout;
+
+	if(ioctl(fd, SG_IO, &io_hdr) == -1)
+		return false;
+
+	if((io_hdr.info & SG_INFO_OK_MASK) != SG_INFO_OK)
+		return false;
+
+	// A short transfer leaves part of the buffer unread
+	return io_hdr.resid == 0;
+
+}
+
+/**
+ * Open a drive to read blocks with READ(12), see struct dvd_drive_reader.
+ * Only works on block devices.
+ */
+bool dvd_drive_reader_open(struct dvd_drive_reader *dvd_drive_reader, const char *device_filename, uint32_t lb_start, uint32_t retries, uint32_t timeout) {
+
+	struct stat device_stat;
+	unsigned short max_sectors = 0;
+
+	memset(dvd_drive_reader, 0, sizeof(struct dvd_drive_reader));
+	dvd_drive_reader->fd = -1;
+	dvd_drive_reader->lb_start = lb_start;
+	dvd_drive_reader->retries = retries;
+	dvd_drive_reader->timeout = timeout;
+	dvd_drive_reader->max_blocks = DVD_DRIVE_BLOCKS;
+
+	if(stat(device_filename, &device_stat) == -1 || !S_ISBLK(device_stat.st_mode))
+		return false;
+
+	dvd_drive_reader->fd = open(device_filename, O_RDONLY | O_NONBLOCK);
+	if(dvd_drive_reader->fd == -1)
+		return false;
+
+	// The kernel's limit is in 512 byte sectors, and it writes an unsigned
+	// short for block devices
+	if(ioctl(dvd_drive_reader->fd, BLKSECTGET, &max_sectors) == 0 && max_sectors >= 4)
+		dvd_drive_reader->max_blocks = (uint32_t)max_sectors / 4;
+
+	if(dvd_drive_reader->max_blocks > DVD_DRIVE_BLOCKS_MAX)
+		dvd_drive_reader->max_blocks = DVD_DRIVE_BLOCKS_MAX;
+
+	return true;
+
+}
+
+/**
+ * Send one READ(12) command for a run of blocks
+ */
+static bool dvd_drive_read_12(struct dvd_drive_reader *dvd_drive_reader, uint64_t offset, uint64_t blocks, unsigned char *buffer) {
+
+	unsigned char cdb[12];
+	uint32_t lba = dvd_drive_reader->lb_start + (uint32_t)offset;
+
+	memset(cdb, 0, sizeof(cdb));
+
+	cdb[0] = DVD_DRIVE_READ_12;
+	cdb[2] = (unsigned char)((lba >> 24) & 0xff);
+	cdb[3] = (unsigned char)((lba >> 16) & 0xff);
+	cdb[4] = (unsigned char)((lba >> 8) & 0xff);
+	cdb[5] = (unsigned char)(lba & 0xff);
+	cdb[6] = (unsigned char)((blocks >> 24) & 0xff);
+	cdb[7] = (unsigned char)((blocks >> 16) & 0xff);
+	cdb[8] = (unsigned char)((blocks >> 8) & 0xff);
+	cdb[9] = (unsigned char)(blocks & 0xff);
+
+	dvd_drive_reader->commands++;
+
+	if(dvd_drive_command(dvd_drive_reader->fd, cdb, sizeof(cdb), buffer, (unsigned int)(blocks * DVD_VIDEO_LB_LEN), SG_DXFER_FROM_DEV, dvd_drive_reader->timeout))
+		return true;
+
+	dvd_drive_reader->failed_commands++;
+
+	return false;
+
+}
+
+/**
+ * Read a run of blocks that fits in one command, splitting it up if it
+ * fails, the same as dvd_read_blocks()
+ */
+static uint64_t dvd_drive_read_run(struct dvd_drive_reader *dvd_drive_reader, uint64_t offset, uint64_t blocks, unsigned char *buffer, bool *bad) {
+
+	uint32_t attempt = 0;
+
+	if(blocks == 0)
+		return 0;
+
+	if(dvd_drive_read_12(dvd_drive_reader, offset, blocks, buffer)) {
+		if(bad != NULL)
+			memset(bad, false, blocks * sizeof(bool));
+		return 0;
+	}
+
+	// Only single blocks are retried, a larger range is split up first
+	if(blocks == 1) {
+
+		for(attempt = 0; attempt < dvd_drive_reader->retries; attempt++) {
+			if(dvd_drive_read_12(dvd_drive_reader, offset, 1, buffer)) {
+				if(bad != NULL)
+					bad[0] = false;
+				return 0;
+			}
+		}
+
+		memset(buffer, '\0', DVD_VIDEO_LB_LEN);
+		if(bad != NULL)
+			bad[0] = true;
+		return 1;
+
+	}
+
+	uint64_t first_half = blocks / 2;
+	uint64_t bad_blocks = 0;
+
+	bad_blocks += dvd_drive_read_run(dvd_drive_reader, offset, first_half, buffer, bad);
+	bad_blocks += dvd_drive_read_run(dvd_drive_reader, offset + first_half, blocks - first_half, buffer + (first_half * DVD_VIDEO_LB_LEN), bad == NULL ? NULL : bad + first_half);
+
+	return bad_blocks;
+
+}
+
+/**
+ * Read a run of blocks from the drive, in as few commands as the kernel
+ * allows. Same as dvd_read_blocks(), returns the number of blocks that
+ * could not be read.
+ */
+uint64_t dvd_drive_read_blocks(struct dvd_drive_reader *dvd_drive_reader, uint64_t offset, uint64_t blocks, unsigned char *buffer, bool *bad) {
+
+	uint64_t block = 0;
+	uint64_t run = 0;
+	uint64_t bad_blocks = 0;
+
+	while(block < blocks) {
+
+		run = blocks - block;
+		if(run > dvd_drive_reader->max_blocks)
+			run = dvd_drive_reader->max_blocks;
+
+		bad_blocks += dvd_drive_read_run(dvd_drive_reader, offset + block, run, buffer + (block * DVD_VIDEO_LB_LEN), bad == NULL ? NULL : bad + block);
+
+		block += run;
+
+	}
+
+	return bad_blocks;
+
+}
+
+void dvd_drive_reader_close(struct dvd_drive_reader *dvd_drive_reader) {
+
+	if(dvd_drive_reader->fd != -1)
+		close(dvd_drive_reader->fd);
+
+	dvd_drive_reader->fd = -1;
+
+}
+
+#else
+
+bool dvd_drive_reader_open(struct dvd_drive_reader *dvd_drive_reader, const char *device_filename, uint32_t lb_start, uint32_t retries, uint32_t timeout) {
+
+	(void)device_filename;
+	(void)lb_start;
+	(void)retries;
+	(void)timeout;
+
+	memset(dvd_drive_reader, 0, sizeof(struct dvd_drive_reader));
+	dvd_drive_reader->fd = -1;
+
+	return false;
+
+}
+
+uint64_t dvd_drive_read_blocks(struct dvd_drive_reader *dvd_drive_reader, uint64_t offset, uint64_t blocks, unsigned char *buffer, bool *bad) {
+
+	(void)dvd_drive_reader;
+	(void)offset;
+
+	memset(buffer, '\0', blocks * DVD_VIDEO_LB_LEN);
+	if(bad != NULL)
+		memset(bad, true, blocks * sizeof(bool));
+
+	return blocks;
+
+}
+
+void dvd_drive_reader_close(struct dvd_drive_reader *dvd_drive_reader) {
+
+	dvd_drive_reader->fd = -1;
+
+}
+
 #endif
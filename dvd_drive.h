@@ -2,14 +2,67 @@
 #define DVD_INFO_DRIVE_H
 
 #include <stdio.h>
+#include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include "dvd_device.h"
 
+#ifndef DVD_VIDEO_LB_LEN
+#define DVD_VIDEO_LB_LEN 2048
+#endif
+
+// MMC READ(12)
+#define DVD_DRIVE_READ_12 0xa8
+
+// Times a single block is read again before it's marked as bad
+#define DVD_DRIVE_RETRIES 2
+
+// How long the drive has to finish a command, in milliseconds
+#define DVD_DRIVE_TIMEOUT 20000
+
+// Blocks per command if the kernel doesn't say, 64 KiB
+#define DVD_DRIVE_BLOCKS 32
+
+// Upper limit of blocks per command, 8 MiB
+#define DVD_DRIVE_BLOCKS_MAX 4096
+
+/**
+ * Read blocks from a drive with SCSI READ(12) commands sent through SG_IO,
+ * instead of going through libdvdread and the block layer.
+ *
+ * Each command asks for as many blocks as the kernel will take in one
+ * request (BLKSECTGET), so a large read is a few big commands. A command
+ * that fails is split in half and sent again, like dvd_read_blocks(), and
+ * single blocks that fail are tried again up to retries times before they
+ * are zeroed out and marked bad. The timeout is per command, so a drive
+ * that is stuck on a bad sector gives up instead of hanging the copy.
+ *
+ * The sectors are read as they are on the disc, which means they are still
+ * scrambled if the disc uses CSS. Decrypting them is left to libdvdread, so
+ * check for it (see dvd_source_pack_scrambled()) before using this.
+ *
+ * Offsets are in blocks from lb_start, the first sector of the file being
+ * read, so they are the same as for DVDReadBlocks().
+ */
+struct dvd_drive_reader {
+	int fd;
+	uint32_t lb_start;
+	uint32_t max_blocks;
+	uint32_t retries;
+	uint32_t timeout;
+	uint64_t commands;
+	uint64_t failed_commands;
+};
+
 #ifdef __linux__
 
 #include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <scsi/sg.h>
 
 int dvd_drive_get_status(const char *device_filename);
 
@@ -22,6 +75,15 @@ bool dvd_drive_is_closed(const char *device_filename);
 bool dvd_drive_is_ready(const char *device_filename);
 
 void dvd_drive_display_status(const char *device_filename);
+
+bool dvd_drive_command(int fd, unsigned char *cdb, unsigned char cdb_len, unsigned char *data, unsigned int data_len, int direction, unsigned int timeout);
+
 #endif
 
+bool dvd_drive_reader_open(struct dvd_drive_reader *dvd_drive_reader, const char *device_filename, uint32_t lb_start, uint32_t retries, uint32_t timeout);
+
+uint64_t dvd_drive_read_blocks(struct dvd_drive_reader *dvd_drive_reader, uint64_t offset, uint64_t blocks, unsigned char *buffer, bool *bad);
+
+void dvd_drive_reader_close(struct dvd_drive_reader *dvd_drive_reader);
+
 #endif
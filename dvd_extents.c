@@ -0,0 +1,173 @@
+#include "dvd_extents.h"
+
+/**
+ * Functions used to plan the sector ranges of a copy
+ */
+
+void dvd_extents_init(struct dvd_extents *dvd_extents) {
+
+	dvd_extents->extents = 0;
+	dvd_extents->size = 0;
+	dvd_extents->blocks = 0;
+	dvd_extents->extent = NULL;
+
+}
+
+bool dvd_extents_add(struct dvd_extents *dvd_extents, uint64_t first_sector, uint64_t last_sector) {
+
+	struct dvd_extent *extent = NULL;
+
+	// A cell that ends before it starts has nothing to copy
+	if(last_sector < first_sector)
+		return true;
+
+	// Merge with the last extent if the range is adjacent to or overlaps it
+	if(dvd_extents->extents) {
+
+		extent = &dvd_extents->extent[dvd_extents->extents - 1];
+
+		if(first_sector >= extent->first_sector && first_sector <= extent->last_sector + 1) {
+			if(last_sector > extent->last_sector) {
+				dvd_extents->blocks += last_sector - extent->last_sector;
+				extent->last_sector = last_sector;
+			}
+			return true;
+		}
+
+	}
+
+	if(dvd_extents->extents == dvd_extents->size) {
+
+		uint32_t size = dvd_extents->size ? dvd_extents->size * 2 : 16;
+
+		extent = realloc(dvd_extents->extent, size * sizeof(struct dvd_extent));
+		if(extent == NULL)
+			return false;
+
+		dvd_extents->extent = extent;
+		dvd_extents->size = size;
+
+	}
+
+	extent = &dvd_extents->extent[dvd_extents->extents];
+	extent->first_sector = first_sector;
+	extent->last_sector = last_sector;
+	dvd_extents->extents++;
+	dvd_extents->blocks += last_sector - first_sector + 1;
+
+	return true;
+
+}
+
+bool dvd_extents_save(struct dvd_extents *dvd_extents, const char *filename) {
+
+	FILE *extents_file = NULL;
+	uint32_t ix = 0;
+
+	extents_file = fopen(filename, "w");
+	if(extents_file == NULL)
+		return false;
+
+	fprintf(extents_file, "# first_sector last_sector\n");
+
+	for(ix = 0; ix < dvd_extents->extents; ix++)
+		fprintf(extents_file, "%" PRIu64 " %" PRIu64 "\n", dvd_extents->extent[ix].first_sector, dvd_extents->extent[ix].last_sector);
+
+	if(fclose(extents_file) != 0)
+		return false;
+
+	return true;
+
+}
+
+bool dvd_extents_load(struct dvd_extents *dvd_extents, const char *filename) {
+
+	FILE *extents_file = NULL;
+	char line[64];
+	uint64_t first_sector = 0;
+	uint64_t last_sector = 0;
+	bool retval = true;
+
+	extents_file = fopen(filename, "r");
+	if(extents_file == NULL)
+		return errno == ENOENT;
+
+	while(fgets(line, sizeof(line), extents_file) != NULL) {
+
+		if(sscanf(line, "%" SCNu64 " %" SCNu64, &first_sector, &last_sector) != 2)
+			continue;
+
+		if(!dvd_extents_add(dvd_extents, first_sector, last_sector)) {
+			retval = false;
+			break;
+		}
+
+	}
+
+	if(ferror(extents_file))
+		retval = false;
+
+	fclose(extents_file);
+
+	return retval;
+
+}
+
+static int dvd_extents_compare(const void *a, const void *b) {
+
+	const struct dvd_extent *extent_a = a;
+	const struct dvd_extent *extent_b = b;
+
+	if(extent_a->first_sector < extent_b->first_sector)
+		return -1;
+
+	if(extent_a->first_sector > extent_b->first_sector)
+		return 1;
+
+	return 0;
+
+}
+
+void dvd_extents_sort(struct dvd_extents *dvd_extents) {
+
+	struct dvd_extent *extent = NULL;
+	uint32_t ix = 0;
+	uint32_t extents = 0;
+
+	if(dvd_extents->extents == 0)
+		return;
+
+	qsort(dvd_extents->extent, dvd_extents->extents, sizeof(struct dvd_extent), dvd_extents_compare);
+
+	extent = &dvd_extents->extent[0];
+	extents = 1;
+	dvd_extents->blocks = extent->last_sector - extent->first_sector + 1;
+
+	for(ix = 1; ix < dvd_extents->extents; ix++) {
+
+		if(dvd_extents->extent[ix].first_sector <= extent->last_sector + 1) {
+			if(dvd_extents->extent[ix].last_sector > extent->last_sector) {
+				dvd_extents->blocks += dvd_extents->extent[ix].last_sector - extent->last_sector;
+				extent->last_sector = dvd_extents->extent[ix].last_sector;
+			}
+			continue;
+		}
+
+		extent = &dvd_extents->extent[extents];
+		*extent = dvd_extents->extent[ix];
+		dvd_extents->blocks += extent->last_sector - extent->first_sector + 1;
+		extents++;
+
+	}
+
+	dvd_extents->extents = extents;
+
+}
+
+void dvd_extents_free(struct dvd_extents *dvd_extents) {
+
+	free(dvd_extents->extent);
+
+	dvd_extents_init(dvd_extents);
+
+}
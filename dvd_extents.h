@@ -0,0 +1,93 @@
+#ifndef DVD_INFO_EXTENTS_H
+#define DVD_INFO_EXTENTS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+
+/**
+ * A list of sector ranges to copy, in the order they are played back.
+ *
+ * Copying a track one cell at a time means stopping at every cell boundary,
+ * even though most tracks are just one long run of sectors (see the
+ * sequential example in dvd_cell.h). Cells are added to the list in playback
+ * order, and any cell that starts right after, or inside of, the last extent
+ * is merged into it. A cell that jumps somewhere else starts a new extent,
+ * so tracks with an unusual structure are still copied in the same order.
+ *
+ * Example:
+ * Cell: 01, First sector: 4112, Last sector: 53741
+ * Cell: 02, First sector: 53742, Last sector: 103173
+ * Cell: 03, First sector: 993631, Last sector: 1001433
+ *
+ * Extent: 1, First sector: 4112, Last sector: 103173
+ * Extent: 2, First sector: 993631, Last sector: 1001433
+ */
+
+struct dvd_extent {
+	uint64_t first_sector;
+	uint64_t last_sector;
+};
+
+struct dvd_extents {
+	uint32_t extents;
+	uint32_t size;
+	uint64_t blocks;
+	struct dvd_extent *extent;
+};
+
+void dvd_extents_init(struct dvd_extents *dvd_extents);
+
+/**
+ * Add a range of sectors, both ends included. A range that ends before it
+ * starts is skipped. Returns false if memory can't be allocated.
+ */
+bool dvd_extents_add(struct dvd_extents *dvd_extents, uint64_t first_sector, uint64_t last_sector);
+
+/**
+ * Save the list to a text file, one extent per line as the first and last
+ * sector separated by a space. This is used for the map of sectors that
+ * couldn't be read, so that a later pass only has to retry those.
+ *
+ * Example:
+ * # first_sector last_sector
+ * 53742 53749
+ * 993631 993631
+ *
+ * Returns false if the file can't be written.
+ */
+bool dvd_extents_save(struct dvd_extents *dvd_extents, const char *filename);
+
+/**
+ * Add the extents from a file written by dvd_extents_save(), so that a copy
+ * that is resumed keeps the map of sectors an earlier pass couldn't read.
+ * Lines that aren't a pair of sectors are skipped, and a file that doesn't
+ * exist is the same as an empty one.
+ *
+ * Returns false if the file can't be read or memory can't be allocated.
+ */
+bool dvd_extents_load(struct dvd_extents *dvd_extents, const char *filename);
+
+/**
+ * Put the extents in order of their first sector, and merge any that are
+ * adjacent or overlap, so that every sector is in the list just once. This
+ * turns the combined extents of several tracks into one pass across the
+ * disc.
+ *
+ * Example:
+ * Extent: 1, First sector: 993631, Last sector: 1001433
+ * Extent: 2, First sector: 4112, Last sector: 53741
+ * Extent: 3, First sector: 53742, Last sector: 103173
+ * Extent: 4, First sector: 4112, Last sector: 53741
+ *
+ * Extent: 1, First sector: 4112, Last sector: 103173
+ * Extent: 2, First sector: 993631, Last sector: 1001433
+ */
+void dvd_extents_sort(struct dvd_extents *dvd_extents);
+
+void dvd_extents_free(struct dvd_extents *dvd_extents);
+
+#endif
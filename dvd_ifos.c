@@ -0,0 +1,39 @@
+#include "dvd_ifos.h"
+
+/**
+ * Functions used to keep the IFOs of a disc open
+ */
+
+void dvd_ifos_init(struct dvd_ifos *dvd_ifos, dvd_reader_t *dvdread_dvd) {
+
+	memset(dvd_ifos, 0, sizeof(struct dvd_ifos));
+	dvd_ifos->dvdread_dvd = dvdread_dvd;
+
+}
+
+ifo_handle_t *dvd_ifos_vts(struct dvd_ifos *dvd_ifos, uint16_t vts) {
+
+	if(vts >= DVD_MAX_VTS_IFOS)
+		return NULL;
+
+	if(!dvd_ifos->opened[vts]) {
+		dvd_ifos->vts_ifo[vts] = ifoOpen(dvd_ifos->dvdread_dvd, vts);
+		dvd_ifos->opened[vts] = true;
+	}
+
+	return dvd_ifos->vts_ifo[vts];
+
+}
+
+void dvd_ifos_close(struct dvd_ifos *dvd_ifos) {
+
+	uint16_t vts = 0;
+
+	for(vts = 0; vts < DVD_MAX_VTS_IFOS; vts++) {
+		if(dvd_ifos->vts_ifo[vts])
+			ifoClose(dvd_ifos->vts_ifo[vts]);
+		dvd_ifos->vts_ifo[vts] = NULL;
+		dvd_ifos->opened[vts] = false;
+	}
+
+}
@@ -0,0 +1,48 @@
+#ifndef DVD_INFO_IFOS_H
+#define DVD_INFO_IFOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <dvdread/dvd_reader.h>
+#include <dvdread/ifo_read.h>
+#include "dvd_specs.h"
+
+/**
+ * The IFOs of the title sets on a disc, each opened once.
+ *
+ * Every track is in a title set, and there are usually many more tracks
+ * than title sets, so opening the VTS IFO for each track parses the same
+ * one over and over. On discs with dozens of fake playlists that is most
+ * of the time spent. Here each IFO is opened the first time it is asked
+ * for, and kept until dvd_ifos_close().
+ *
+ * Example:
+ * struct dvd_ifos dvd_ifos;
+ * dvd_ifos_init(&dvd_ifos, dvdread_dvd);
+ * vts_ifo = dvd_ifos_vts(&dvd_ifos, 1);
+ * dvd_ifos_close(&dvd_ifos);
+ */
+
+struct dvd_ifos {
+	dvd_reader_t *dvdread_dvd;
+	bool opened[DVD_MAX_VTS_IFOS];
+	ifo_handle_t *vts_ifo[DVD_MAX_VTS_IFOS];
+};
+
+void dvd_ifos_init(struct dvd_ifos *dvd_ifos, dvd_reader_t *dvdread_dvd);
+
+/**
+ * IFO of a title set, opening it if it hasn't been yet.
+ *
+ * Returns NULL if it can't be opened, and doesn't try again. The IFO
+ * belongs to the cache, don't ifoClose() it.
+ */
+ifo_handle_t *dvd_ifos_vts(struct dvd_ifos *dvd_ifos, uint16_t vts);
+
+/**
+ * Close all the IFOs that were opened
+ */
+void dvd_ifos_close(struct dvd_ifos *dvd_ifos);
+
+#endif
@@ -0,0 +1,175 @@
+#include "dvd_index.h"
+
+/**
+ * Functions used to write and read the seek index of a copied track
+ */
+
+static void dvd_index_put32(unsigned char *data, uint32_t value) {
+
+	data[0] = (unsigned char)(value & 0xff);
+	data[1] = (unsigned char)((value >> 8) & 0xff);
+	data[2] = (unsigned char)((value >> 16) & 0xff);
+	data[3] = (unsigned char)((value >> 24) & 0xff);
+
+}
+
+static uint32_t dvd_index_get32(const unsigned char *data) {
+
+	return (uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24;
+
+}
+
+static bool dvd_index_header(FILE *file, uint32_t entries) {
+
+	unsigned char header[DVD_INDEX_HEADER_SIZE];
+
+	memcpy(header, DVD_INDEX_MAGIC, 8);
+	dvd_index_put32(header + 8, DVD_INDEX_VERSION);
+	dvd_index_put32(header + 12, entries);
+
+	return fwrite(header, DVD_INDEX_HEADER_SIZE, 1, file) == 1;
+
+}
+
+bool dvd_index_open(struct dvd_index *dvd_index, const char *filename) {
+
+	memset(dvd_index, 0, sizeof(struct dvd_index));
+	strncpy(dvd_index->filename, filename, PATH_MAX - 1);
+
+	dvd_index->file = fopen(filename, "wb");
+	if(dvd_index->file == NULL)
+		return false;
+
+	// The number of entries is filled in once they are all written
+	if(!dvd_index_header(dvd_index->file, 0)) {
+		fclose(dvd_index->file);
+		dvd_index->file = NULL;
+		return false;
+	}
+
+	return true;
+
+}
+
+bool dvd_index_add(struct dvd_index *dvd_index, struct dvd_index_entry *dvd_index_entry) {
+
+	unsigned char data[DVD_INDEX_ENTRY_SIZE];
+
+	if(dvd_index->file == NULL)
+		return false;
+
+	dvd_index_put32(data, (uint32_t)(dvd_index_entry->offset & 0xffffffff));
+	dvd_index_put32(data + 4, (uint32_t)(dvd_index_entry->offset >> 32));
+	dvd_index_put32(data + 8, dvd_index_entry->msecs);
+	dvd_index_put32(data + 12, dvd_index_entry->pts);
+	dvd_index_put32(data + 16, dvd_index_entry->sector);
+	data[20] = dvd_index_entry->chapter;
+	data[21] = dvd_index_entry->cell;
+	data[22] = 0;
+	data[23] = 0;
+
+	if(fwrite(data, DVD_INDEX_ENTRY_SIZE, 1, dvd_index->file) != 1)
+		return false;
+
+	dvd_index->entries++;
+
+	return true;
+
+}
+
+bool dvd_index_close(struct dvd_index *dvd_index) {
+
+	bool retval = true;
+
+	if(dvd_index->file == NULL)
+		return false;
+
+	if(fseek(dvd_index->file, 0, SEEK_SET) != 0 || !dvd_index_header(dvd_index->file, dvd_index->entries))
+		retval = false;
+
+	if(fclose(dvd_index->file) != 0)
+		retval = false;
+
+	dvd_index->file = NULL;
+
+	return retval;
+
+}
+
+bool dvd_index_load(const char *filename, struct dvd_index_entry **dvd_index_entries, uint32_t *entries) {
+
+	FILE *file = NULL;
+	unsigned char header[DVD_INDEX_HEADER_SIZE];
+	unsigned char data[DVD_INDEX_ENTRY_SIZE];
+	struct dvd_index_entry *dvd_index_entry = NULL;
+	uint32_t ix = 0;
+
+	*dvd_index_entries = NULL;
+	*entries = 0;
+
+	file = fopen(filename, "rb");
+	if(file == NULL)
+		return false;
+
+	if(fread(header, DVD_INDEX_HEADER_SIZE, 1, file) != 1 || memcmp(header, DVD_INDEX_MAGIC, 8) != 0 || dvd_index_get32(header + 8) != DVD_INDEX_VERSION) {
+		fclose(file);
+		return false;
+	}
+
+	*entries = dvd_index_get32(header + 12);
+	if(*entries == 0) {
+		fclose(file);
+		return true;
+	}
+
+	*dvd_index_entries = calloc(*entries, sizeof(struct dvd_index_entry));
+	if(*dvd_index_entries == NULL) {
+		*entries = 0;
+		fclose(file);
+		return false;
+	}
+
+	for(ix = 0; ix < *entries; ix++) {
+
+		if(fread(data, DVD_INDEX_ENTRY_SIZE, 1, file) != 1) {
+			free(*dvd_index_entries);
+			*dvd_index_entries = NULL;
+			*entries = 0;
+			fclose(file);
+			return false;
+		}
+
+		dvd_index_entry = &(*dvd_index_entries)[ix];
+		dvd_index_entry->offset = (uint64_t)dvd_index_get32(data) | (uint64_t)dvd_index_get32(data + 4) << 32;
+		dvd_index_entry->msecs = dvd_index_get32(data + 8);
+		dvd_index_entry->pts = dvd_index_get32(data + 12);
+		dvd_index_entry->sector = dvd_index_get32(data + 16);
+		dvd_index_entry->chapter = data[20];
+		dvd_index_entry->cell = data[21];
+
+	}
+
+	fclose(file);
+
+	return true;
+
+}
+
+uint32_t dvd_index_find(const struct dvd_index_entry *dvd_index_entries, uint32_t entries, uint32_t msecs) {
+
+	uint32_t low = 0;
+	uint32_t high = entries;
+	uint32_t middle = 0;
+
+	// Find the first entry after the time, the one before it has it
+	while(low < high) {
+		middle = low + (high - low) / 2;
+		if(dvd_index_entries[middle].msecs <= msecs)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low ? low - 1 : 0;
+
+}
@@ -0,0 +1,98 @@
+#ifndef DVD_INFO_INDEX_H
+#define DVD_INFO_INDEX_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#ifdef __linux__
+#include <linux/limits.h>
+#else
+#include <limits.h>
+#endif
+
+#define DVD_INDEX_MAGIC "DVDINDEX"
+#define DVD_INDEX_VERSION 1
+#define DVD_INDEX_HEADER_SIZE 16
+#define DVD_INDEX_ENTRY_SIZE 24
+
+/**
+ * A seek index for a copied track, with one entry for every VOBU in it.
+ *
+ * Every VOBU (about half a second of video) starts with a NAV pack, which
+ * has the presentation time of the VOBU in its PCI packet, and the time
+ * since the start of its cell in its DSI packet. dvd_copy --index records
+ * where each one ended up in the output, so a player or an encoder can
+ * find a time in the copy by a binary search, instead of reading through
+ * the file until it gets there.
+ *
+ * The file is binary, and every number in it is little-endian.
+ *
+ * Header, 16 bytes:
+ * 8 bytes "DVDINDEX"
+ * 4 bytes version (1)
+ * 4 bytes number of entries
+ *
+ * Entry, 24 bytes:
+ * 8 bytes offset of the NAV pack in the output, in bytes
+ * 4 bytes time since the start of the copy, in milliseconds
+ * 4 bytes presentation time of the VOBU (VOBU_S_PTM), 90 kHz
+ * 4 bytes sector of the NAV pack in the title set
+ * 1 byte chapter number
+ * 1 byte cell number
+ * 2 bytes unused (0)
+ *
+ * Entries are in the same order as the output, so both the offsets and
+ * the times since the start of the copy only ever go up.
+ *
+ * Example:
+ * VOBU:    1, Offset:          0, Time: 00:00:00.000, PTS:  1067, Sector:   5192, Chapter: 01, Cell: 01
+ * VOBU:    2, Offset:     389120, Time: 00:00:00.500, PTS: 46067, Sector:   5382, Chapter: 01, Cell: 01
+ */
+
+struct dvd_index_entry {
+	uint64_t offset;
+	uint32_t msecs;
+	uint32_t pts;
+	uint32_t sector;
+	uint8_t chapter;
+	uint8_t cell;
+};
+
+struct dvd_index {
+	FILE *file;
+	char filename[PATH_MAX];
+	uint32_t entries;
+};
+
+/**
+ * Create the index file. Returns false if it can't be written.
+ */
+bool dvd_index_open(struct dvd_index *dvd_index, const char *filename);
+
+/**
+ * Add an entry to the end of the index. Returns false on error.
+ */
+bool dvd_index_add(struct dvd_index *dvd_index, struct dvd_index_entry *dvd_index_entry);
+
+/**
+ * Fill in the number of entries in the header, and close the file. Returns
+ * false on error.
+ */
+bool dvd_index_close(struct dvd_index *dvd_index);
+
+/**
+ * Read a whole index into memory, the entries have to be freed after.
+ * Returns false if the file can't be read, or isn't an index.
+ */
+bool dvd_index_load(const char *filename, struct dvd_index_entry **dvd_index_entries, uint32_t *entries);
+
+/**
+ * Find the last entry at or before a time since the start of the copy, with
+ * a binary search. Returns the entry number, starting at 0.
+ */
+uint32_t dvd_index_find(const struct dvd_index_entry *dvd_index_entries, uint32_t entries, uint32_t msecs);
+
+#endif
@@ -23,6 +23,8 @@
 #include "dvd_xchap.h"
 #include "dvd_vob.h"
 #include "dvd_init.h"
+#include "dvd_ifos.h"
+#include "dvd_index.h"
 #ifdef __linux__
 #include <linux/cdrom.h>
 #include <linux/limits.h>
@@ -53,6 +55,12 @@ int main(int argc, char **argv) {
 	bool p_dvd_xchap = false;
 	bool p_dvd_id = false;
 	bool p_dvd_title = false;
+	bool p_dvd_index = false;
+	char index_filename[PATH_MAX] = {'\0'};
+	struct dvd_index_entry *dvd_index_entries = NULL;
+	uint32_t index_entries = 0;
+	uint32_t index_ix = 0;
+	char index_time[13];
 
 	// lsdvd similar display output
 	bool d_audio = false;
@@ -104,6 +112,7 @@ int main(int argc, char **argv) {
 	dvd_reader_t *dvdread_dvd = NULL;
 	ifo_handle_t *vmg_ifo = NULL;
 	ifo_handle_t *vts_ifo = NULL;
+	struct dvd_ifos dvd_ifos;
 
 	// DVD
 	struct dvd_info dvd_info;
@@ -121,7 +130,7 @@ int main(int argc, char **argv) {
 	int ix = 0;
 	int opt = 0;
 	bool invalid_opt = false;
-	const char p_short_opts[] = "aAcdeE:gG:hijlLM:N:sST:t:uVvxyz";
+	const char p_short_opts[] = "aAcdeE:gG:hiI:jlLM:N:sST:t:uVvxyz";
 	struct option p_long_opts[] = {
 
 		{ "track", required_argument, NULL, 't' },
@@ -139,6 +148,7 @@ int main(int argc, char **argv) {
 		{ "xchap", no_argument, NULL, 'g' },
 		{ "id", no_argument, NULL, 'i' },
 		{ "volume", no_argument, NULL, 'u' },
+		{ "index", required_argument, NULL, 'I' },
 
 		{ "longest", required_argument, NULL, 'l' },
 		{ "min-seconds", required_argument, NULL, 'E' },
@@ -208,6 +218,11 @@ int main(int argc, char **argv) {
 				p_dvd_id = true;
 				break;
 
+			case 'I':
+				p_dvd_index = true;
+				strncpy(index_filename, optarg, PATH_MAX - 1);
+				break;
+
 			case 'j':
 				p_dvd_json = true;
 				d_disc_title_header = false;
@@ -337,6 +352,7 @@ int main(int argc, char **argv) {
 				printf("  -i, --id		Display DVD ID only\n");
 				printf("  -u, --volume		Display DVD UDF volume name only (for ISO or disc)\n");
 				printf("  -g, --xchap           Display title's chapter format for mkvmerge\n");
+				printf("  -I, --index <file>    Display a seek index saved by dvd_copy --index\n");
 				printf("  -h, --help            Display these help options\n");
 				printf("  -v, --verbose         Display verbose output\n");
 				printf("  -z, --debug           Display debugging output\n");
@@ -368,6 +384,25 @@ int main(int argc, char **argv) {
 	if(valid_args == false)
 		return 1;
 
+	// Display a seek index, there's no need for a DVD
+	if(p_dvd_index) {
+
+		if(!dvd_index_load(index_filename, &dvd_index_entries, &index_entries)) {
+			fprintf(stderr, "Opening index %s failed\n", index_filename);
+			return 1;
+		}
+
+		for(index_ix = 0; index_ix < index_entries; index_ix++) {
+			milliseconds_length_format(index_time, dvd_index_entries[index_ix].msecs);
+			printf("VOBU: %*" PRIu32 ", Offset: %*" PRIu64 ", Time: %s, PTS: %*" PRIu32 ", Sector: %*" PRIu32 ", Chapter: %02" PRIu8 ", Cell: %02" PRIu8 "\n", 4, index_ix + 1, 10, dvd_index_entries[index_ix].offset, index_time, 10, dvd_index_entries[index_ix].pts, 7, dvd_index_entries[index_ix].sector, dvd_index_entries[index_ix].chapter, dvd_index_entries[index_ix].cell);
+		}
+
+		free(dvd_index_entries);
+
+		return 0;
+
+	}
+
 	/** Begin dvd_info :) */
 
 	// Use a custom function to send logs to (and shut up the annoying ones)
@@ -385,6 +420,7 @@ int main(int argc, char **argv) {
 	vmg_ifo = ifoOpen(dvdread_dvd, 0);
 	if(vmg_ifo == NULL || !ifo_is_vmg(vmg_ifo)) {
 		fprintf(stderr, "Opening VMG IFO failed, can not open DVD\n");
+		dvd_vts_stat_reset();
 		DVDClose(dvdread_dvd);
 		return 1;
 	}
@@ -409,6 +445,7 @@ int main(int argc, char **argv) {
 	if(opt_track_number && (arg_track_number > dvd_info.tracks || arg_track_number < 1)) {
 		fprintf(stderr, "Valid track numbers: 1 to %" PRIu16 "\n", dvd_info.tracks);
 		ifoClose(vmg_ifo);
+		dvd_vts_stat_reset();
 		DVDClose(dvdread_dvd);
 		return 1;
 	} else if(opt_track_number) {
@@ -425,16 +462,19 @@ int main(int argc, char **argv) {
 		return 1;
 	}
 
+	// Each VTS IFO is opened once, and used by all of its tracks
+	dvd_ifos_init(&dvd_ifos, dvdread_dvd);
+
 	// Do some checks to see if a VTS is ok or not
 	for(vts = 1; vts < dvd_info.video_title_sets + 1; vts++)
-		dvd_vts[vts] = dvd_vts_open(dvdread_dvd, vts);
+		dvd_vts[vts] = dvd_vts_open(dvdread_dvd, dvd_ifos_vts(&dvd_ifos, vts), vts);
 
 	/**
 	 * Track information
 	 */
 
 	struct dvd_track *dvd_tracks;
-	dvd_tracks = dvd_tracks_init(dvdread_dvd, vmg_ifo, d_audio, d_subtitles, d_chapters, d_cells);
+	dvd_tracks = dvd_tracks_init(&dvd_ifos, vmg_ifo, d_audio, d_subtitles, d_chapters, d_cells);
 
 	dvd_info.longest_track = dvd_tracks[0].track;
 
@@ -571,30 +611,18 @@ int main(int argc, char **argv) {
 		if(d_has_alang || d_has_slang) {
 			if(dvd_vts[dvd_track.vts].valid == false) {
 				fprintf(stderr, "VTS %" PRIu16 " is invalid, skipping\n", dvd_track.vts);
-			} else {
-				vts_ifo = ifoOpen(dvdread_dvd, dvd_track.vts);
+				continue;
 			}
+			vts_ifo = dvd_ifos_vts(&dvd_ifos, dvd_track.vts);
 		}
 
 		// Skip if audio track language stream isn't found
-		if(d_has_alang && !dvd_track_has_audio_lang_code(vts_ifo, d_alang)) {
-			ifoClose(vts_ifo);
-			vts_ifo = NULL;
+		if(d_has_alang && !dvd_track_has_audio_lang_code(vts_ifo, d_alang))
 			continue;
-		}
 
 		// Skip if subtitle language stream isn't found
-		if(d_has_slang && !dvd_track_has_subtitle_lang_code(vts_ifo, d_slang)) {
-			ifoClose(vts_ifo);
-			vts_ifo = NULL;
+		if(d_has_slang && !dvd_track_has_subtitle_lang_code(vts_ifo, d_slang))
 			continue;
-		}
-
-		// Close out for next round
-		if(vts_ifo) {
-			ifoClose(vts_ifo);
-			vts_ifo = NULL;
-		}
 
 		// Display track information
 		printf("Track: %*" PRIu16 ", ", 2, dvd_track.track);
@@ -704,8 +732,9 @@ int main(int argc, char **argv) {
 	if(vmg_ifo)
 		ifoClose(vmg_ifo);
 
-	if(vts_ifo)
-		ifoClose(vts_ifo);
+	dvd_ifos_close(&dvd_ifos);
+
+	dvd_vts_stat_reset();
 
 	if(dvdread_dvd)
 		DVDClose(dvdread_dvd);
@@ -5,7 +5,7 @@
  * audio, subtitles and cells are all zero-base indexed
  */
 
-struct dvd_track dvd_track_init(dvd_reader_t *dvdread_dvd, ifo_handle_t *vmg_ifo, uint16_t track_number, bool init_audio, bool init_subtitles, bool init_chapters, bool init_cells) {
+struct dvd_track dvd_track_init(struct dvd_ifos *dvd_ifos, ifo_handle_t *vmg_ifo, uint16_t track_number, bool init_audio, bool init_subtitles, bool init_chapters, bool init_cells) {
 
 	struct dvd_track dvd_track;
 	struct dvd_video dvd_video;
@@ -55,7 +55,8 @@ struct dvd_track dvd_track_init(dvd_reader_t *dvdread_dvd, ifo_handle_t *vmg_ifo
 	// These are hard to find, so an example DVD is '4b4d78c077ea78576a7de09aee7715d4'
 	dvd_track.vts = dvd_vts_ifo_number(vmg_ifo, track_number);
 
-	vts_ifo = ifoOpen(dvdread_dvd, dvd_track.vts);
+	// Tracks in the same title set share its IFO
+	vts_ifo = dvd_ifos_vts(dvd_ifos, dvd_track.vts);
 
 	if(vts_ifo == NULL) {
 		dvd_track.valid = false;
@@ -216,7 +217,7 @@ struct dvd_track dvd_track_init(dvd_reader_t *dvdread_dvd, ifo_handle_t *vmg_ifo
 
 }
 
-struct dvd_track *dvd_tracks_init(dvd_reader_t *dvdread_dvd, ifo_handle_t *vmg_ifo, bool init_audio, bool init_subtitles, bool init_chapters, bool init_cells) {
+struct dvd_track *dvd_tracks_init(struct dvd_ifos *dvd_ifos, ifo_handle_t *vmg_ifo, bool init_audio, bool init_subtitles, bool init_chapters, bool init_cells) {
 
 	uint16_t track_number = 1;
 	uint16_t longest_track = 1;
@@ -225,7 +226,7 @@ struct dvd_track *dvd_tracks_init(dvd_reader_t *dvdread_dvd, ifo_handle_t *vmg_i
 	struct dvd_track *tracks = calloc(num_tracks + 1, sizeof(struct dvd_track));
 
 	for(track_number = 1; track_number < num_tracks + 1; track_number++) {
-		tracks[track_number] = dvd_track_init(dvdread_dvd, vmg_ifo, track_number, init_audio, init_subtitles, init_chapters, init_cells);
+		tracks[track_number] = dvd_track_init(dvd_ifos, vmg_ifo, track_number, init_audio, init_subtitles, init_chapters, init_cells);
 
 		if(tracks[track_number].msecs > longest_msecs) {
 			longest_track = track_number;
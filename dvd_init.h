@@ -5,6 +5,7 @@
 #include "dvd_audio.h"
 #include "dvd_cell.h"
 #include "dvd_chapter.h"
+#include "dvd_ifos.h"
 #include "dvd_info.h"
 #include "dvd_subtitles.h"
 #include "dvd_time.h"
@@ -13,8 +14,8 @@
 #include "dvd_vmg_ifo.h"
 #include "dvd_vts.h"
 
-struct dvd_track dvd_track_init(dvd_reader_t *dvdread_dvd, ifo_handle_t *vmg_ifo, uint16_t track_number, bool init_audio, bool init_subtitles, bool init_chapters, bool init_cells);
+struct dvd_track dvd_track_init(struct dvd_ifos *dvd_ifos, ifo_handle_t *vmg_ifo, uint16_t track_number, bool init_audio, bool init_subtitles, bool init_chapters, bool init_cells);
 
-struct dvd_track *dvd_tracks_init(dvd_reader_t *dvdread_dvd, ifo_handle_t *vmg_ifo, bool init_audio, bool init_subtitles, bool init_chapters, bool init_cells);
+struct dvd_track *dvd_tracks_init(struct dvd_ifos *dvd_ifos, ifo_handle_t *vmg_ifo, bool init_audio, bool init_subtitles, bool init_chapters, bool init_cells);
 
 #endif
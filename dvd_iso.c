@@ -0,0 +1,198 @@
+#include "dvd_iso.h"
+
+/**
+ * Functions used to copy a whole disc to an image
+ */
+
+/**
+ * Add the range of a VOB to the ones that are read through libdvdread
+ */
+static void dvd_iso_add_range(struct dvd_iso *dvd_iso, dvd_reader_t *dvdread_dvd, const char *udf_filename, uint16_t vts, dvd_read_domain_t domain) {
+
+	uint32_t lb_start = 0;
+	uint32_t udf_filesize = 0;
+	ssize_t blocks = 0;
+	dvd_file_t *dvdread_file = NULL;
+	struct dvd_iso_range *range = NULL;
+
+	if(dvd_iso->ranges == DVD_ISO_RANGES)
+		return;
+
+	lb_start = UDFFindFile(dvdread_dvd, udf_filename, &udf_filesize);
+	if(lb_start == 0 || lb_start >= dvd_iso->blocks)
+		return;
+
+	dvdread_file = DVDOpenFile(dvdread_dvd, vts, domain);
+	if(dvdread_file == NULL)
+		return;
+
+	blocks = DVDFileSize(dvdread_file);
+	if(blocks <= 0) {
+		DVDCloseFile(dvdread_file);
+		return;
+	}
+
+	range = &dvd_iso->range[dvd_iso->ranges];
+	range->first_sector = lb_start;
+	range->blocks = (uint64_t)blocks;
+	range->dvdread_file = dvdread_file;
+
+	// Don't go past the end of the disc
+	if(range->first_sector + range->blocks > dvd_iso->blocks)
+		range->blocks = dvd_iso->blocks - range->first_sector;
+
+	dvd_iso->ranges++;
+
+}
+
+bool dvd_iso_open(struct dvd_iso *dvd_iso, dvd_reader_t *dvdread_dvd, const char *device_filename, uint16_t video_title_sets) {
+
+	struct stat device_stat;
+	uint64_t bytes = 0;
+	uint16_t vts = 0;
+	char udf_filename[32];
+
+	memset(dvd_iso, 0, sizeof(struct dvd_iso));
+	dvd_iso->fd = -1;
+
+	if(stat(device_filename, &device_stat) == -1)
+		return false;
+
+	if(!S_ISBLK(device_stat.st_mode) && !S_ISREG(device_stat.st_mode))
+		return false;
+
+	dvd_iso->fd = open(device_filename, O_RDONLY);
+	if(dvd_iso->fd == -1)
+		return false;
+
+	if(S_ISREG(device_stat.st_mode))
+		bytes = (uint64_t)device_stat.st_size;
+#ifdef __linux__
+	else if(ioctl(dvd_iso->fd, BLKGETSIZE64, &bytes) == -1)
+		bytes = 0;
+#endif
+
+	dvd_iso->blocks = bytes / DVD_VIDEO_LB_LEN;
+	if(dvd_iso->blocks == 0) {
+		dvd_iso_close(dvd_iso);
+		return false;
+	}
+
+	dvd_iso_add_range(dvd_iso, dvdread_dvd, "/VIDEO_TS/VIDEO_TS.VOB", 0, DVD_READ_MENU_VOBS);
+
+	for(vts = 1; vts < video_title_sets + 1; vts++) {
+
+		snprintf(udf_filename, sizeof(udf_filename), "/VIDEO_TS/VTS_%02" PRIu16 "_0.VOB", vts);
+		dvd_iso_add_range(dvd_iso, dvdread_dvd, udf_filename, vts, DVD_READ_MENU_VOBS);
+
+		// The title VOBs follow each other, and libdvdread reads them
+		// as one file
+		snprintf(udf_filename, sizeof(udf_filename), "/VIDEO_TS/VTS_%02" PRIu16 "_1.VOB", vts);
+		dvd_iso_add_range(dvd_iso, dvdread_dvd, udf_filename, vts, DVD_READ_TITLE_VOBS);
+
+	}
+
+	return true;
+
+}
+
+/**
+ * Read sectors straight from the drive or image, splitting the range up if
+ * it can't be read, the same as dvd_read_blocks()
+ */
+static uint64_t dvd_iso_read_raw(struct dvd_iso *dvd_iso, uint64_t sector, uint64_t blocks, unsigned char *buffer, bool *bad) {
+
+	ssize_t bytes = (ssize_t)(blocks * DVD_VIDEO_LB_LEN);
+
+	if(blocks == 0)
+		return 0;
+
+	if(pread(dvd_iso->fd, buffer, (size_t)bytes, (off_t)(sector * DVD_VIDEO_LB_LEN)) == bytes) {
+		if(bad != NULL)
+			memset(bad, false, blocks * sizeof(bool));
+		return 0;
+	}
+
+	if(blocks == 1) {
+		memset(buffer, '\0', DVD_VIDEO_LB_LEN);
+		if(bad != NULL)
+			bad[0] = true;
+		return 1;
+	}
+
+	uint64_t first_half = blocks / 2;
+	uint64_t bad_blocks = 0;
+
+	bad_blocks += dvd_iso_read_raw(dvd_iso, sector, first_half, buffer, bad);
+	bad_blocks += dvd_iso_read_raw(dvd_iso, sector + first_half, blocks - first_half, buffer + (first_half * DVD_VIDEO_LB_LEN), bad == NULL ? NULL : bad + first_half);
+
+	return bad_blocks;
+
+}
+
+uint64_t dvd_iso_read_blocks(struct dvd_iso *dvd_iso, uint64_t sector, uint64_t blocks, unsigned char *buffer, bool *bad) {
+
+	uint64_t run = 0;
+	uint64_t bad_blocks = 0;
+	uint16_t ix = 0;
+	struct dvd_iso_range *range = NULL;
+	struct dvd_iso_range *in_range = NULL;
+
+	while(blocks) {
+
+		// Read up to the end of the VOB the sector is in, or up to the
+		// start of the next one
+		run = blocks;
+		in_range = NULL;
+
+		for(ix = 0; ix < dvd_iso->ranges; ix++) {
+
+			range = &dvd_iso->range[ix];
+
+			if(sector >= range->first_sector && sector < range->first_sector + range->blocks) {
+				in_range = range;
+				if(run > range->first_sector + range->blocks - sector)
+					run = range->first_sector + range->blocks - sector;
+				break;
+			}
+
+			if(range->first_sector > sector && run > range->first_sector - sector)
+				run = range->first_sector - sector;
+
+		}
+
+		if(in_range) {
+			bad_blocks += dvd_read_blocks(in_range->dvdread_file, sector - in_range->first_sector, run, buffer, bad);
+			dvd_iso->decrypted_blocks += run;
+		} else {
+			bad_blocks += dvd_iso_read_raw(dvd_iso, sector, run, buffer, bad);
+		}
+
+		sector += run;
+		blocks -= run;
+		buffer += run * DVD_VIDEO_LB_LEN;
+		if(bad != NULL)
+			bad += run;
+
+	}
+
+	return bad_blocks;
+
+}
+
+void dvd_iso_close(struct dvd_iso *dvd_iso) {
+
+	uint16_t ix = 0;
+
+	for(ix = 0; ix < dvd_iso->ranges; ix++) {
+		if(dvd_iso->range[ix].dvdread_file)
+			DVDCloseFile(dvd_iso->range[ix].dvdread_file);
+		dvd_iso->range[ix].dvdread_file = NULL;
+	}
+	dvd_iso->ranges = 0;
+
+	if(dvd_iso->fd != -1)
+		close(dvd_iso->fd);
+	dvd_iso->fd = -1;
+
+}
@@ -0,0 +1,85 @@
+#ifndef DVD_INFO_ISO_H
+#define DVD_INFO_ISO_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+#include <dvdread/dvd_reader.h>
+#include <dvdread/dvd_udf.h>
+#include "dvd_blocks.h"
+
+#ifndef DVD_VIDEO_LB_LEN
+#define DVD_VIDEO_LB_LEN 2048
+#endif
+
+// VIDEO_TS.VOB, and a menu and title VOBs for each of 99 title sets
+#define DVD_ISO_RANGES 199
+
+/**
+ * Read a whole disc in the order it is on the disc, from the first sector
+ * to the last, with the VOBs decrypted in place.
+ *
+ * Outside of the VOBs (the UDF and ISO 9660 filesystems, the IFOs, and any
+ * padding between files) nothing is scrambled, so those sectors are read
+ * straight from the drive or image. The VOBs may be scrambled with CSS, so
+ * each VOB is found in the UDF filesystem, and the sectors in its range are
+ * read through libdvdread instead, which decrypts them. libdvdcss clears the
+ * scrambling bits of the sectors it decrypts, so the image that comes out
+ * plays as an unencrypted disc.
+ *
+ * Both kinds of reads are done in large runs, split only where a VOB starts
+ * or ends.
+ *
+ * Example of the ranges on a disc:
+ * Sector 0 to 2403: filesystem, IFOs (raw)
+ * Sector 2404 to 2871: VIDEO_TS.VOB (decrypted)
+ * Sector 2872 to 2899: IFOs (raw)
+ * Sector 2900 to 1923488: VTS_01_1.VOB to VTS_01_5.VOB (decrypted)
+ */
+
+struct dvd_iso_range {
+	uint64_t first_sector;
+	uint64_t blocks;
+	dvd_file_t *dvdread_file;
+};
+
+struct dvd_iso {
+	int fd;
+	uint64_t blocks;
+	uint16_t ranges;
+	struct dvd_iso_range range[DVD_ISO_RANGES];
+	uint64_t decrypted_blocks;
+};
+
+/**
+ * Open the drive or image for raw reads, find its size, and look up where
+ * each VOB is.
+ *
+ * Returns false if the source isn't a drive or an image (a VIDEO_TS
+ * directory has no disc to copy), or its size can't be found.
+ */
+bool dvd_iso_open(struct dvd_iso *dvd_iso, dvd_reader_t *dvdread_dvd, const char *device_filename, uint16_t video_title_sets);
+
+/**
+ * Read a run of sectors of the disc into a buffer, decrypting any that are
+ * in a VOB. Same as dvd_read_blocks(), blocks that can't be read are zeroed
+ * out and set in bad.
+ *
+ * Returns the number of blocks that could not be read.
+ */
+uint64_t dvd_iso_read_blocks(struct dvd_iso *dvd_iso, uint64_t sector, uint64_t blocks, unsigned char *buffer, bool *bad);
+
+void dvd_iso_close(struct dvd_iso *dvd_iso);
+
+#endif
@@ -0,0 +1,304 @@
+#include "dvd_journal.h"
+
+/**
+ * Functions used to keep track of how much of a copy is done
+ */
+
+static uint32_t dvd_journal_crc_table[256];
+static bool dvd_journal_crc_init = false;
+
+static void dvd_journal_crc_table_init(void) {
+
+	uint32_t crc = 0;
+	uint32_t ix = 0;
+	uint32_t bit = 0;
+
+	if(dvd_journal_crc_init)
+		return;
+
+	for(ix = 0; ix < 256; ix++) {
+		crc = ix;
+		for(bit = 0; bit < 8; bit++)
+			crc = (crc & 1) ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+		dvd_journal_crc_table[ix] = crc;
+	}
+
+	dvd_journal_crc_init = true;
+
+}
+
+uint32_t dvd_journal_crc32(uint32_t crc, const unsigned char *data, size_t bytes) {
+
+	size_t ix = 0;
+
+	dvd_journal_crc_table_init();
+
+	crc = ~crc;
+
+	for(ix = 0; ix < bytes; ix++)
+		crc = dvd_journal_crc_table[(crc ^ data[ix]) & 0xff] ^ (crc >> 8);
+
+	return ~crc;
+
+}
+
+/**
+ * Read a range from a line of the journal, the checksum is set to an empty
+ * string if there isn't one
+ */
+static bool dvd_journal_range(const char *line, uint64_t *first_block, uint64_t *last_block, char *checksum) {
+
+	if(sscanf(line, "%" SCNu64 " %" SCNu64 " %8s", first_block, last_block, checksum) != 3)
+		return false;
+
+	if(*last_block < *first_block)
+		return false;
+
+	if(strcmp(checksum, "-") == 0)
+		checksum[0] = '\0';
+
+	return true;
+
+}
+
+/**
+ * Read a range back from the output, and compare it to the checksum
+ */
+static bool dvd_journal_check(int fd, uint64_t first_block, uint64_t last_block, const char *checksum) {
+
+	unsigned char buffer[DVD_VIDEO_LB_LEN * 64];
+	uint64_t block = first_block;
+	uint64_t blocks = 0;
+	uint32_t crc = 0;
+	char range_checksum[9];
+	off_t output_size = 0;
+
+	output_size = lseek(fd, 0, SEEK_END);
+	if(output_size < (off_t)((last_block + 1) * DVD_VIDEO_LB_LEN))
+		return false;
+
+	if(strlen(checksum) == 0)
+		return true;
+
+	while(block < last_block + 1) {
+
+		blocks = last_block + 1 - block;
+		if(blocks > 64)
+			blocks = 64;
+
+		if(pread(fd, buffer, blocks * DVD_VIDEO_LB_LEN, (off_t)(block * DVD_VIDEO_LB_LEN)) != (ssize_t)(blocks * DVD_VIDEO_LB_LEN))
+			return false;
+
+		crc = dvd_journal_crc32(crc, buffer, blocks * DVD_VIDEO_LB_LEN);
+		block += blocks;
+
+	}
+
+	snprintf(range_checksum, sizeof(range_checksum), "%08" PRIx32, crc);
+
+	return strcmp(range_checksum, checksum) == 0;
+
+}
+
+uint64_t dvd_journal_resume(const char *journal_filename, const char *description, const char *output_filename) {
+
+	FILE *journal_file = NULL;
+	char line[PATH_MAX];
+	char header[PATH_MAX];
+	char checksum[9];
+	uint64_t first_block = 0;
+	uint64_t last_block = 0;
+	uint64_t blocks = 0;
+	uint64_t *ranges = NULL;
+	uint64_t *resized = NULL;
+	char (*checksums)[9] = NULL;
+	char (*resized_checksums)[9] = NULL;
+	uint32_t ix = 0;
+	uint32_t count = 0;
+	int fd = -1;
+
+	journal_file = fopen(journal_filename, "r");
+	if(journal_file == NULL)
+		return 0;
+
+	snprintf(header, PATH_MAX, "# %s\n", description);
+
+	if(fgets(line, PATH_MAX, journal_file) == NULL || strcmp(line, header) != 0) {
+		fclose(journal_file);
+		return 0;
+	}
+
+	// Keep the ranges in order, they have to pick up right where the last
+	// one left off
+	while(fgets(line, PATH_MAX, journal_file) != NULL) {
+
+		if(!dvd_journal_range(line, &first_block, &last_block, checksum) || first_block != blocks)
+			break;
+
+		resized = realloc(ranges, (count + 1) * 2 * sizeof(uint64_t));
+		if(resized == NULL)
+			break;
+		ranges = resized;
+
+		resized_checksums = realloc(checksums, (count + 1) * sizeof(*checksums));
+		if(resized_checksums == NULL)
+			break;
+		checksums = resized_checksums;
+
+		ranges[count * 2] = first_block;
+		ranges[count * 2 + 1] = last_block;
+		strcpy(checksums[count], checksum);
+		count++;
+
+		blocks = last_block + 1;
+
+	}
+
+	fclose(journal_file);
+
+	blocks = 0;
+
+	fd = open(output_filename, O_RDONLY);
+
+	// Find the last range that made it to the output
+	for(ix = count; fd != -1 && ranges != NULL && checksums != NULL && ix > 0; ix--) {
+		if(dvd_journal_check(fd, ranges[(ix - 1) * 2], ranges[(ix - 1) * 2 + 1], checksums[ix - 1])) {
+			blocks = ranges[(ix - 1) * 2 + 1] + 1;
+			break;
+		}
+	}
+
+	if(fd != -1)
+		close(fd);
+
+	free(ranges);
+	free(checksums);
+
+	return blocks;
+
+}
+
+bool dvd_journal_open(struct dvd_journal *dvd_journal, const char *journal_filename, const char *description, uint64_t blocks) {
+
+	FILE *journal_file = NULL;
+	FILE *old_journal_file = NULL;
+	char old_journal_filename[PATH_MAX];
+	char line[PATH_MAX];
+	char checksum[9];
+	uint64_t first_block = 0;
+	uint64_t last_block = 0;
+
+	dvd_journal_crc_table_init();
+
+	memset(dvd_journal, 0, sizeof(struct dvd_journal));
+	strncpy(dvd_journal->filename, journal_filename, PATH_MAX - 1);
+	dvd_journal->checksum = true;
+
+	// Keep the ranges that are already done, and write the rest from scratch
+	snprintf(old_journal_filename, PATH_MAX, "%s.old", journal_filename);
+	if(blocks)
+		rename(journal_filename, old_journal_filename);
+
+	// Put the old one back if there can't be a new one, so the output
+	// still isn't taken as finished
+	journal_file = fopen(journal_filename, "w");
+	if(journal_file == NULL) {
+		if(blocks)
+			rename(old_journal_filename, journal_filename);
+		return false;
+	}
+
+	fprintf(journal_file, "# %s\n", description);
+
+	if(blocks)
+		old_journal_file = fopen(old_journal_filename, "r");
+
+	if(old_journal_file != NULL) {
+
+		// Skip the description
+		if(fgets(line, PATH_MAX, old_journal_file) == NULL)
+			line[0] = '\0';
+
+		while(fgets(line, PATH_MAX, old_journal_file) != NULL) {
+			if(!dvd_journal_range(line, &first_block, &last_block, checksum) || last_block + 1 > blocks)
+				break;
+			fputs(line, journal_file);
+			dvd_journal->blocks = last_block + 1;
+		}
+
+		fclose(old_journal_file);
+		unlink(old_journal_filename);
+
+	}
+
+	// Resuming partway through a range, the blocks before that are already
+	// on disk, but only go in with the next one
+	if(dvd_journal->blocks < blocks) {
+		dvd_journal->pending_blocks = blocks - dvd_journal->blocks;
+		dvd_journal->checksum = false;
+	}
+
+	if(fflush(journal_file) != 0 || fsync(fileno(journal_file)) != 0) {
+		fclose(journal_file);
+		return false;
+	}
+
+	dvd_journal->file = journal_file;
+
+	return true;
+
+}
+
+void dvd_journal_update(struct dvd_journal *dvd_journal, const unsigned char *data, uint64_t blocks) {
+
+	if(data == NULL)
+		dvd_journal->checksum = false;
+	else if(dvd_journal->checksum)
+		dvd_journal->crc = dvd_journal_crc32(dvd_journal->crc, data, blocks * DVD_VIDEO_LB_LEN);
+
+	dvd_journal->pending_blocks += blocks;
+
+}
+
+bool dvd_journal_due(struct dvd_journal *dvd_journal) {
+
+	return dvd_journal->pending_blocks >= DVD_JOURNAL_BLOCKS;
+
+}
+
+bool dvd_journal_commit(struct dvd_journal *dvd_journal) {
+
+	if(dvd_journal->file == NULL)
+		return false;
+
+	if(dvd_journal->pending_blocks == 0)
+		return true;
+
+	if(dvd_journal->checksum)
+		fprintf(dvd_journal->file, "%" PRIu64 " %" PRIu64 " %08" PRIx32 "\n", dvd_journal->blocks, dvd_journal->blocks + dvd_journal->pending_blocks - 1, dvd_journal->crc);
+	else
+		fprintf(dvd_journal->file, "%" PRIu64 " %" PRIu64 " -\n", dvd_journal->blocks, dvd_journal->blocks + dvd_journal->pending_blocks - 1);
+
+	if(fflush(dvd_journal->file) != 0 || fsync(fileno(dvd_journal->file)) != 0)
+		return false;
+
+	dvd_journal->blocks += dvd_journal->pending_blocks;
+	dvd_journal->pending_blocks = 0;
+	dvd_journal->crc = 0;
+	dvd_journal->checksum = true;
+
+	return true;
+
+}
+
+void dvd_journal_close(struct dvd_journal *dvd_journal, bool complete) {
+
+	if(dvd_journal->file != NULL)
+		fclose(dvd_journal->file);
+
+	dvd_journal->file = NULL;
+
+	if(complete)
+		unlink(dvd_journal->filename);
+
+}
@@ -0,0 +1,104 @@
+#ifndef DVD_INFO_JOURNAL_H
+#define DVD_INFO_JOURNAL_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#ifdef __linux__
+#include <linux/limits.h>
+#else
+#include <limits.h>
+#endif
+
+#ifndef DVD_VIDEO_LB_LEN
+#define DVD_VIDEO_LB_LEN 2048
+#endif
+
+// How often to commit the progress of a copy, 32 MiB
+#define DVD_JOURNAL_BLOCKS 16384
+
+/**
+ * A journal of how much of an output file has been safely written, so that
+ * a copy that fails partway through can pick up where it left off.
+ *
+ * The journal is a text file next to the output. The first line describes
+ * what is being copied, so a journal is never used to resume a different
+ * copy. Every DVD_JOURNAL_BLOCKS, once the output has been synced to disk,
+ * a line is added with the range of blocks in the output that are done, and
+ * a CRC-32 of their contents. Ranges with data that didn't pass through the
+ * program (see dvd_output_splice()) have no checksum, and use '-' instead.
+ *
+ * Example:
+ * # dvd_copy track 1 blocks 2183120
+ * 0 16383 8b0c3a1f
+ * 16384 32767 -
+ *
+ * When resuming, the last range is read back from the output and checked
+ * against its checksum. If it doesn't match, or the file is too short, the
+ * range is dropped and the one before it is checked, and so on. Copying
+ * starts again right after the last range that checks out.
+ *
+ * When the copy is complete, the journal is removed.
+ */
+
+struct dvd_journal {
+	FILE *file;
+	char filename[PATH_MAX];
+	uint64_t blocks;
+	uint64_t pending_blocks;
+	uint32_t crc;
+	bool checksum;
+};
+
+/**
+ * Calculate a running CRC-32 (the same as zlib and gzip use). Start with a
+ * crc of 0.
+ */
+uint32_t dvd_journal_crc32(uint32_t crc, const unsigned char *data, size_t bytes);
+
+/**
+ * Find out how many blocks of the output are already done. Returns 0 if
+ * there is no journal, it is for a different copy, or nothing in the output
+ * checks out.
+ */
+uint64_t dvd_journal_resume(const char *journal_filename, const char *description, const char *output_filename);
+
+/**
+ * Start the journal. If blocks are already done (see dvd_journal_resume()),
+ * the ranges that cover them are kept, and any after them are dropped. If
+ * blocks ends partway through a range, the rest of it is added to the next
+ * one, without a checksum.
+ *
+ * Returns false if the journal can't be written.
+ */
+bool dvd_journal_open(struct dvd_journal *dvd_journal, const char *journal_filename, const char *description, uint64_t blocks);
+
+/**
+ * Add data written to the output to the range that will be committed next.
+ * If data is NULL, the blocks can't be checksummed.
+ */
+void dvd_journal_update(struct dvd_journal *dvd_journal, const unsigned char *data, uint64_t blocks);
+
+/**
+ * True if enough blocks are pending that it's time to commit them.
+ */
+bool dvd_journal_due(struct dvd_journal *dvd_journal);
+
+/**
+ * Write the pending range to the journal. The output must already be synced.
+ *
+ * Returns false if the journal can't be written.
+ */
+bool dvd_journal_commit(struct dvd_journal *dvd_journal);
+
+/**
+ * Close the journal, and remove it if the copy is complete.
+ */
+void dvd_journal_close(struct dvd_journal *dvd_journal, bool complete);
+
+#endif
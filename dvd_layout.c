@@ -0,0 +1,613 @@
+#include "dvd_layout.h"
+
+/**
+ * Functions used to map the files of a disc to its sectors
+ */
+
+// Descriptor tags of the UDF filesystem
+#define DVD_LAYOUT_TAG_AVDP 2
+#define DVD_LAYOUT_TAG_PD 5
+#define DVD_LAYOUT_TAG_LVD 6
+#define DVD_LAYOUT_TAG_TD 8
+#define DVD_LAYOUT_TAG_FSD 256
+#define DVD_LAYOUT_TAG_FID 257
+#define DVD_LAYOUT_TAG_FE 261
+#define DVD_LAYOUT_TAG_EFE 266
+
+// Where the UDF and ISO 9660 filesystems start
+#define DVD_LAYOUT_AVDP_SECTOR 256
+#define DVD_LAYOUT_PVD_SECTOR 16
+
+// File characteristics of a UDF File Identifier
+#define DVD_LAYOUT_FID_DIRECTORY 0x02
+#define DVD_LAYOUT_FID_DELETED 0x04
+#define DVD_LAYOUT_FID_PARENT 0x08
+
+// File flags of an ISO 9660 directory record
+#define DVD_LAYOUT_ISO_DIRECTORY 0x02
+#define DVD_LAYOUT_ISO_MULTI_EXTENT 0x80
+
+// Both filesystems are little endian
+static uint16_t dvd_layout_u16(const unsigned char *data) {
+
+	return (uint16_t)(data[0] | (data[1] << 8));
+
+}
+
+static uint32_t dvd_layout_u32(const unsigned char *data) {
+
+	return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+
+}
+
+static uint64_t dvd_layout_u64(const unsigned char *data) {
+
+	return (uint64_t)dvd_layout_u32(data) | ((uint64_t)dvd_layout_u32(data + 4) << 32);
+
+}
+
+static bool dvd_layout_read(int fd, uint32_t lb, uint32_t blocks, unsigned char *buffer) {
+
+	ssize_t bytes = (ssize_t)blocks * DVD_VIDEO_LB_LEN;
+
+	return pread(fd, buffer, (size_t)bytes, (off_t)lb * DVD_VIDEO_LB_LEN) == bytes;
+
+}
+
+/**
+ * Check that a UDF descriptor has the tag that is expected, and that the
+ * checksum of the tag is right
+ */
+static bool dvd_layout_tag(const unsigned char *data, uint16_t tag_id) {
+
+	uint8_t checksum = 0;
+	uint8_t ix = 0;
+
+	for(ix = 0; ix < 16; ix++) {
+		if(ix != 4)
+			checksum += data[ix];
+	}
+
+	return dvd_layout_u16(data) == tag_id && data[4] == checksum;
+
+}
+
+/**
+ * Add an extent to a file, merging it with the one before if it follows
+ * right after it. Extents past DVD_LAYOUT_EXTENTS are dropped.
+ */
+static void dvd_layout_extent(struct dvd_layout_file *dvd_layout_file, uint32_t lb_start, uint64_t bytes) {
+
+	uint32_t blocks = (uint32_t)((bytes + DVD_VIDEO_LB_LEN - 1) / DVD_VIDEO_LB_LEN);
+	struct dvd_layout_extent *extent = NULL;
+
+	if(blocks == 0)
+		return;
+
+	if(dvd_layout_file->extents) {
+		extent = &dvd_layout_file->extent[dvd_layout_file->extents - 1];
+		if(extent->lb_start + extent->blocks == lb_start) {
+			extent->blocks += blocks;
+			return;
+		}
+	}
+
+	if(dvd_layout_file->extents == DVD_LAYOUT_EXTENTS)
+		return;
+
+	extent = &dvd_layout_file->extent[dvd_layout_file->extents];
+	extent->lb_start = lb_start;
+	extent->blocks = blocks;
+
+	dvd_layout_file->extents++;
+
+}
+
+/**
+ * Add a file to the table. Returns false if memory can't be allocated.
+ */
+static bool dvd_layout_add(struct dvd_layout *dvd_layout, struct dvd_layout_file *dvd_layout_file) {
+
+	struct dvd_layout_file *file = NULL;
+
+	if(dvd_layout->files == UINT16_MAX)
+		return false;
+
+	if(dvd_layout->files == dvd_layout->size) {
+		file = realloc(dvd_layout->file, (dvd_layout->size + 64) * sizeof(struct dvd_layout_file));
+		if(file == NULL)
+			return false;
+		dvd_layout->file = file;
+		dvd_layout->size += 64;
+	}
+
+	dvd_layout->file[dvd_layout->files] = *dvd_layout_file;
+	dvd_layout->files++;
+
+	return true;
+
+}
+
+/**
+ * Read the data of a directory, from the extents it is in. Returns a buffer
+ * that has to be freed, or NULL if it can't be read.
+ */
+static unsigned char *dvd_layout_directory(int fd, struct dvd_layout_file *directory, uint32_t *bytes) {
+
+	unsigned char *data = NULL;
+	uint32_t blocks = 0;
+	uint8_t ix = 0;
+
+	*bytes = 0;
+
+	if(directory->size == 0 || directory->size > DVD_LAYOUT_DIRECTORY_MAX)
+		return NULL;
+
+	for(ix = 0; ix < directory->extents; ix++)
+		blocks += directory->extent[ix].blocks;
+
+	if(blocks == 0 || blocks > DVD_LAYOUT_DIRECTORY_MAX / DVD_VIDEO_LB_LEN)
+		return NULL;
+
+	data = calloc(blocks, DVD_VIDEO_LB_LEN);
+	if(data == NULL)
+		return NULL;
+
+	blocks = 0;
+	for(ix = 0; ix < directory->extents; ix++) {
+		if(!dvd_layout_read(fd, directory->extent[ix].lb_start, directory->extent[ix].blocks, data + (blocks * DVD_VIDEO_LB_LEN))) {
+			free(data);
+			return NULL;
+		}
+		blocks += directory->extent[ix].blocks;
+	}
+
+	*bytes = blocks * DVD_VIDEO_LB_LEN;
+	if(*bytes > directory->size)
+		*bytes = (uint32_t)directory->size;
+
+	return data;
+
+}
+
+/**
+ * Read a UDF File Entry, for the size of the file and the extents it is in
+ */
+static bool dvd_layout_udf_entry(int fd, uint32_t partition_start, uint32_t lb, struct dvd_layout_file *dvd_layout_file) {
+
+	unsigned char buffer[DVD_VIDEO_LB_LEN];
+	uint32_t ea_length = 0;
+	uint32_t ad_length = 0;
+	uint32_t ad_offset = 0;
+	uint32_t ad_size = 0;
+	uint32_t ad_bytes = 0;
+	uint32_t ix = 0;
+
+	if(!dvd_layout_read(fd, partition_start + lb, 1, buffer))
+		return false;
+
+	if(dvd_layout_tag(buffer, DVD_LAYOUT_TAG_FE)) {
+		ea_length = dvd_layout_u32(buffer + 168);
+		ad_length = dvd_layout_u32(buffer + 172);
+		ad_offset = 176;
+	} else if(dvd_layout_tag(buffer, DVD_LAYOUT_TAG_EFE)) {
+		ea_length = dvd_layout_u32(buffer + 208);
+		ad_length = dvd_layout_u32(buffer + 212);
+		ad_offset = 216;
+	} else {
+		return false;
+	}
+
+	if(ea_length > DVD_VIDEO_LB_LEN - ad_offset || ad_length > DVD_VIDEO_LB_LEN - ad_offset - ea_length)
+		return false;
+
+	ad_offset += ea_length;
+
+	dvd_layout_file->size = dvd_layout_u64(buffer + 56);
+	dvd_layout_file->extents = 0;
+
+	// Short and long allocation descriptors both start with the length and
+	// the block. Data embedded in the File Entry has no extents of its own.
+	switch(dvd_layout_u16(buffer + 34) & 0x07) {
+		case 0:
+			ad_size = 8;
+			break;
+		case 1:
+			ad_size = 16;
+			break;
+		case 3:
+			return true;
+		default:
+			return false;
+	}
+
+	for(ix = 0; ix + ad_size <= ad_length; ix += ad_size) {
+
+		ad_bytes = dvd_layout_u32(buffer + ad_offset + ix);
+
+		if((ad_bytes & 0x3fffffff) == 0)
+			break;
+
+		// The top two bits are the type, only recorded extents have data
+		if(ad_bytes >> 30)
+			continue;
+
+		dvd_layout_extent(dvd_layout_file, partition_start + dvd_layout_u32(buffer + ad_offset + ix + 4), ad_bytes);
+
+	}
+
+	return true;
+
+}
+
+/**
+ * Get the next UDF File Identifier in a directory, starting at offset.
+ * Names are 8 or 16 bit characters, and only the low byte is kept, which is
+ * all that's needed for the names in VIDEO_TS.
+ *
+ * Returns the offset of the one after it, or 0 if there are no more.
+ */
+static uint32_t dvd_layout_udf_fid(const unsigned char *data, uint32_t bytes, uint32_t offset, char *name, size_t name_size, uint8_t *characteristics, uint32_t *icb_lb) {
+
+	const unsigned char *fid = NULL;
+	const unsigned char *identifier = NULL;
+	uint8_t identifier_length = 0;
+	uint16_t implementation_length = 0;
+	uint32_t length = 0;
+	uint32_t ix = 0;
+	size_t name_length = 0;
+
+	if(offset + 38 > bytes)
+		return 0;
+
+	fid = data + offset;
+	if(!dvd_layout_tag(fid, DVD_LAYOUT_TAG_FID))
+		return 0;
+
+	*characteristics = fid[18];
+	identifier_length = fid[19];
+	*icb_lb = dvd_layout_u32(fid + 24);
+	implementation_length = dvd_layout_u16(fid + 36);
+
+	length = 38 + implementation_length + identifier_length;
+	if(offset + length > bytes)
+		return 0;
+
+	identifier = fid + 38 + implementation_length;
+	memset(name, '\0', name_size);
+
+	if(identifier_length && identifier[0] == 16) {
+		for(ix = 1; ix + 1 < identifier_length && name_length < name_size - 1; ix += 2)
+			name[name_length++] = (char)identifier[ix + 1];
+	} else if(identifier_length) {
+		for(ix = 1; ix < identifier_length && name_length < name_size - 1; ix++)
+			name[name_length++] = (char)identifier[ix];
+	}
+
+	return offset + ((length + 3) & ~3U);
+
+}
+
+/**
+ * Find a directory or file by name in the data of a UDF directory, and read
+ * its File Entry
+ */
+static bool dvd_layout_udf_find(int fd, uint32_t partition_start, const unsigned char *data, uint32_t bytes, const char *filename, struct dvd_layout_file *dvd_layout_file) {
+
+	char name[256];
+	uint8_t characteristics = 0;
+	uint32_t icb_lb = 0;
+	uint32_t offset = 0;
+
+	while((offset = dvd_layout_udf_fid(data, bytes, offset, name, sizeof(name), &characteristics, &icb_lb))) {
+
+		if(characteristics & (DVD_LAYOUT_FID_DELETED | DVD_LAYOUT_FID_PARENT))
+			continue;
+
+		if(strcmp(name, filename) == 0)
+			return dvd_layout_udf_entry(fd, partition_start, icb_lb, dvd_layout_file);
+
+	}
+
+	return false;
+
+}
+
+static bool dvd_layout_udf(struct dvd_layout *dvd_layout, int fd) {
+
+	unsigned char buffer[DVD_VIDEO_LB_LEN];
+	uint32_t vds_lb = 0;
+	uint32_t vds_blocks = 0;
+	uint32_t lb = 0;
+	uint32_t partition_start = 0;
+	uint32_t fsd_lb = 0;
+	bool partition = false;
+	bool logical_volume = false;
+	struct dvd_layout_file directory;
+	struct dvd_layout_file dvd_layout_file;
+	unsigned char *data = NULL;
+	uint32_t bytes = 0;
+	uint32_t offset = 0;
+	uint8_t characteristics = 0;
+	uint32_t icb_lb = 0;
+	char name[256];
+
+	if(!dvd_layout_read(fd, DVD_LAYOUT_AVDP_SECTOR, 1, buffer) || !dvd_layout_tag(buffer, DVD_LAYOUT_TAG_AVDP))
+		return false;
+
+	// The main Volume Descriptor Sequence, which is at least 16 sectors
+	vds_blocks = dvd_layout_u32(buffer + 16) / DVD_VIDEO_LB_LEN;
+	vds_lb = dvd_layout_u32(buffer + 20);
+	if(vds_blocks > 32)
+		vds_blocks = 32;
+
+	for(lb = vds_lb; lb < vds_lb + vds_blocks; lb++) {
+
+		if(!dvd_layout_read(fd, lb, 1, buffer))
+			return false;
+
+		if(dvd_layout_tag(buffer, DVD_LAYOUT_TAG_TD))
+			break;
+
+		// A DVD has one partition, and the files are in it
+		if(!partition && dvd_layout_tag(buffer, DVD_LAYOUT_TAG_PD)) {
+			partition_start = dvd_layout_u32(buffer + 188);
+			partition = true;
+		}
+
+		if(!logical_volume && dvd_layout_tag(buffer, DVD_LAYOUT_TAG_LVD)) {
+			if(dvd_layout_u32(buffer + 212) != DVD_VIDEO_LB_LEN)
+				return false;
+			fsd_lb = dvd_layout_u32(buffer + 252);
+			logical_volume = true;
+		}
+
+	}
+
+	if(!partition || !logical_volume)
+		return false;
+
+	if(!dvd_layout_read(fd, partition_start + fsd_lb, 1, buffer) || !dvd_layout_tag(buffer, DVD_LAYOUT_TAG_FSD))
+		return false;
+
+	memset(&directory, 0, sizeof(struct dvd_layout_file));
+	if(!dvd_layout_udf_entry(fd, partition_start, dvd_layout_u32(buffer + 404), &directory))
+		return false;
+
+	data = dvd_layout_directory(fd, &directory, &bytes);
+	if(data == NULL)
+		return false;
+
+	memset(&directory, 0, sizeof(struct dvd_layout_file));
+	if(!dvd_layout_udf_find(fd, partition_start, data, bytes, "VIDEO_TS", &directory)) {
+		free(data);
+		return false;
+	}
+
+	free(data);
+
+	data = dvd_layout_directory(fd, &directory, &bytes);
+	if(data == NULL)
+		return false;
+
+	while((offset = dvd_layout_udf_fid(data, bytes, offset, name, sizeof(name), &characteristics, &icb_lb))) {
+
+		if(characteristics & (DVD_LAYOUT_FID_DELETED | DVD_LAYOUT_FID_PARENT | DVD_LAYOUT_FID_DIRECTORY))
+			continue;
+
+		if(strlen(name) > 12)
+			continue;
+
+		memset(&dvd_layout_file, 0, sizeof(struct dvd_layout_file));
+		strncpy(dvd_layout_file.filename, name, 12);
+
+		if(!dvd_layout_udf_entry(fd, partition_start, icb_lb, &dvd_layout_file))
+			continue;
+
+		if(!dvd_layout_add(dvd_layout, &dvd_layout_file)) {
+			free(data);
+			return false;
+		}
+
+	}
+
+	free(data);
+
+	dvd_layout->udf = true;
+
+	return true;
+
+}
+
+/**
+ * Get the next ISO 9660 directory record, starting at offset. Records don't
+ * cross sectors, and the rest of a sector after the last one is zeros.
+ * Version numbers (";1") are taken off the names.
+ *
+ * Returns the offset of the one after it, or 0 if there are no more.
+ */
+static uint32_t dvd_layout_iso9660_record(const unsigned char *data, uint32_t bytes, uint32_t offset, char *name, size_t name_size, uint8_t *flags, uint32_t *lb, uint32_t *size) {
+
+	const unsigned char *record = NULL;
+	uint8_t name_length = 0;
+	char *version = NULL;
+
+	while(offset < bytes && data[offset] == 0)
+		offset = (offset / DVD_VIDEO_LB_LEN + 1) * DVD_VIDEO_LB_LEN;
+
+	if(offset + 33 > bytes)
+		return 0;
+
+	record = data + offset;
+	name_length = record[32];
+
+	if(record[0] < 33 + name_length || offset + record[0] > bytes)
+		return 0;
+
+	*lb = dvd_layout_u32(record + 2);
+	*size = dvd_layout_u32(record + 10);
+	*flags = record[25];
+
+	memset(name, '\0', name_size);
+	if(name_length < name_size)
+		memcpy(name, record + 33, name_length);
+
+	version = strchr(name, ';');
+	if(version)
+		*version = '\0';
+
+	return offset + record[0];
+
+}
+
+static bool dvd_layout_iso9660(struct dvd_layout *dvd_layout, int fd) {
+
+	unsigned char buffer[DVD_VIDEO_LB_LEN];
+	struct dvd_layout_file directory;
+	struct dvd_layout_file dvd_layout_file;
+	unsigned char *data = NULL;
+	uint32_t bytes = 0;
+	uint32_t offset = 0;
+	uint8_t flags = 0;
+	uint32_t lb = 0;
+	uint32_t size = 0;
+	bool multi_extent = false;
+	char name[256];
+
+	if(!dvd_layout_read(fd, DVD_LAYOUT_PVD_SECTOR, 1, buffer))
+		return false;
+
+	if(buffer[0] != 1 || memcmp(buffer + 1, "CD001", 5) != 0 || dvd_layout_u16(buffer + 128) != DVD_VIDEO_LB_LEN)
+		return false;
+
+	// The root directory record is in the Primary Volume Descriptor
+	memset(&directory, 0, sizeof(struct dvd_layout_file));
+	directory.size = dvd_layout_u32(buffer + 156 + 10);
+	dvd_layout_extent(&directory, dvd_layout_u32(buffer + 156 + 2), directory.size);
+
+	data = dvd_layout_directory(fd, &directory, &bytes);
+	if(data == NULL)
+		return false;
+
+	memset(&directory, 0, sizeof(struct dvd_layout_file));
+	while((offset = dvd_layout_iso9660_record(data, bytes, offset, name, sizeof(name), &flags, &lb, &size))) {
+		if((flags & DVD_LAYOUT_ISO_DIRECTORY) && strcmp(name, "VIDEO_TS") == 0) {
+			directory.size = size;
+			dvd_layout_extent(&directory, lb, size);
+			break;
+		}
+	}
+
+	free(data);
+
+	data = dvd_layout_directory(fd, &directory, &bytes);
+	if(data == NULL)
+		return false;
+
+	// A file larger than 4 GiB is split into several records, each one
+	// flagged as multi extent except the last
+	offset = 0;
+	while((offset = dvd_layout_iso9660_record(data, bytes, offset, name, sizeof(name), &flags, &lb, &size))) {
+
+		if(flags & DVD_LAYOUT_ISO_DIRECTORY)
+			continue;
+
+		if(multi_extent && dvd_layout->files && strcmp(dvd_layout->file[dvd_layout->files - 1].filename, name) == 0) {
+			dvd_layout->file[dvd_layout->files - 1].size += size;
+			dvd_layout_extent(&dvd_layout->file[dvd_layout->files - 1], lb, size);
+			multi_extent = flags & DVD_LAYOUT_ISO_MULTI_EXTENT;
+			continue;
+		}
+
+		multi_extent = flags & DVD_LAYOUT_ISO_MULTI_EXTENT;
+
+		if(strlen(name) > 12)
+			continue;
+
+		memset(&dvd_layout_file, 0, sizeof(struct dvd_layout_file));
+		strncpy(dvd_layout_file.filename, name, 12);
+		dvd_layout_file.size = size;
+		dvd_layout_extent(&dvd_layout_file, lb, size);
+
+		if(!dvd_layout_add(dvd_layout, &dvd_layout_file)) {
+			free(data);
+			return false;
+		}
+
+	}
+
+	free(data);
+
+	dvd_layout->udf = false;
+
+	return true;
+
+}
+
+bool dvd_layout_open(struct dvd_layout *dvd_layout, const char *device_filename) {
+
+	struct stat device_stat;
+	int fd = -1;
+	bool retval = false;
+
+	memset(dvd_layout, 0, sizeof(struct dvd_layout));
+
+	if(stat(device_filename, &device_stat) == -1)
+		return false;
+
+	if(!S_ISBLK(device_stat.st_mode) && !S_ISREG(device_stat.st_mode))
+		return false;
+
+	fd = open(device_filename, O_RDONLY);
+	if(fd == -1)
+		return false;
+
+	retval = dvd_layout_udf(dvd_layout, fd);
+
+	if(!retval) {
+		dvd_layout_free(dvd_layout);
+		retval = dvd_layout_iso9660(dvd_layout, fd);
+	}
+
+	close(fd);
+
+	if(!retval)
+		dvd_layout_free(dvd_layout);
+
+	return retval;
+
+}
+
+struct dvd_layout_file *dvd_layout_find(struct dvd_layout *dvd_layout, const char *filename) {
+
+	uint16_t ix = 0;
+
+	for(ix = 0; ix < dvd_layout->files; ix++) {
+		if(strcmp(dvd_layout->file[ix].filename, filename) == 0)
+			return &dvd_layout->file[ix];
+	}
+
+	return NULL;
+
+}
+
+uint32_t dvd_layout_lb_start(struct dvd_layout *dvd_layout, const char *filename) {
+
+	struct dvd_layout_file *dvd_layout_file = NULL;
+
+	dvd_layout_file = dvd_layout_find(dvd_layout, filename);
+
+	if(dvd_layout_file == NULL || dvd_layout_file->extents == 0)
+		return 0;
+
+	return dvd_layout_file->extent[0].lb_start;
+
+}
+
+void dvd_layout_free(struct dvd_layout *dvd_layout) {
+
+	free(dvd_layout->file);
+
+	memset(dvd_layout, 0, sizeof(struct dvd_layout));
+
+}
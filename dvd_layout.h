@@ -0,0 +1,98 @@
+#ifndef DVD_INFO_LAYOUT_H
+#define DVD_INFO_LAYOUT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifndef DVD_VIDEO_LB_LEN
+#define DVD_VIDEO_LB_LEN 2048
+#endif
+
+// A VOB is at most 1 GiB, and a UDF extent just under, so two is enough.
+// Files in more extents than that only have the first ones.
+#define DVD_LAYOUT_EXTENTS 2
+
+// Largest directory that is read, VIDEO_TS with every file is about 64 KiB
+#define DVD_LAYOUT_DIRECTORY_MAX (1024 * 1024)
+
+/**
+ * Where each file in VIDEO_TS is on the disc, read straight from the
+ * filesystem of a drive or an image.
+ *
+ * libdvdread looks up a file in the UDF filesystem each time it is asked
+ * for one (UDFFindFile(), DVDFileStat(), DVDOpenFile()), and only hands back
+ * where it starts. Here the filesystem is read once, and every file gets
+ * its size and the extents it is stored in, so a program can plan reading
+ * the disc in the order it is laid out.
+ *
+ * DVD-Video discs have both a UDF and an ISO 9660 filesystem pointing at
+ * the same files. The UDF one is what players use, so it is read first:
+ *
+ * Sector 256: Anchor Volume Descriptor Pointer, to the volume descriptors
+ * Volume descriptors: Partition Descriptor (where the partition starts)
+ *   and Logical Volume Descriptor (where the File Set Descriptor is)
+ * File Set Descriptor: the File Entry of the root directory
+ * Root directory: File Identifiers, one of which is VIDEO_TS
+ * VIDEO_TS: File Identifiers, each pointing to a File Entry with the
+ *   extents of the file
+ *
+ * If there is no UDF filesystem, or it can't be read, the ISO 9660 one
+ * is used instead, starting with its Primary Volume Descriptor at sector
+ * 16 (see dvd_title()).
+ *
+ * Example:
+ * VIDEO_TS.IFO: 12288 bytes, sector 2404
+ * VTS_01_1.VOB: 1073709056 bytes, sector 3200
+ */
+
+struct dvd_layout_extent {
+	uint32_t lb_start;
+	uint32_t blocks;
+};
+
+struct dvd_layout_file {
+	char filename[13];
+	uint64_t size;
+	uint8_t extents;
+	struct dvd_layout_extent extent[DVD_LAYOUT_EXTENTS];
+};
+
+struct dvd_layout {
+	bool udf;
+	uint16_t files;
+	uint16_t size;
+	struct dvd_layout_file *file;
+};
+
+/**
+ * Read the filesystem of a drive or an image, and make a table of the files
+ * in VIDEO_TS.
+ *
+ * Returns false if the source isn't a drive or an image, or neither
+ * filesystem can be read.
+ */
+bool dvd_layout_open(struct dvd_layout *dvd_layout, const char *device_filename);
+
+/**
+ * Find a file in VIDEO_TS by name, such as "VTS_01_1.VOB". Returns NULL if
+ * it isn't on the disc.
+ */
+struct dvd_layout_file *dvd_layout_find(struct dvd_layout *dvd_layout, const char *filename);
+
+/**
+ * First sector of a file, or 0 if it isn't on the disc, the same as
+ * UDFFindFile()
+ */
+uint32_t dvd_layout_lb_start(struct dvd_layout *dvd_layout, const char *filename);
+
+void dvd_layout_free(struct dvd_layout *dvd_layout);
+
+#endif
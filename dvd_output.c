@@ -0,0 +1,824 @@
+#define _GNU_SOURCE
+#include "dvd_output.h"
+
+/**
+ * Functions used to write copied DVD data to files
+ */
+
+static ssize_t dvd_output_pwrite(int fd, const unsigned char *data, size_t bytes, off_t offset) {
+
+	size_t bytes_written = 0;
+	ssize_t retval = 0;
+
+	while(bytes_written < bytes) {
+
+		retval = pwrite(fd, data + bytes_written, bytes - bytes_written, offset + (off_t)bytes_written);
+
+		if(retval < 0 && errno == EINTR)
+			continue;
+
+		if(retval < 0)
+			return -1;
+
+		bytes_written += (size_t)retval;
+
+	}
+
+	return (ssize_t)bytes_written;
+
+}
+
+static ssize_t dvd_output_plain_write(int fd, const unsigned char *data, size_t bytes, bool zero_copy) {
+
+	size_t bytes_written = 0;
+	ssize_t retval = 0;
+#ifdef __linux__
+	struct iovec iov;
+#endif
+
+	while(bytes_written < bytes) {
+
+#ifdef __linux__
+		if(zero_copy) {
+			iov.iov_base = (void *)(data + bytes_written);
+			iov.iov_len = bytes - bytes_written;
+			retval = vmsplice(fd, &iov, 1, 0);
+		} else
+#endif
+		retval = write(fd, data + bytes_written, bytes - bytes_written);
+
+		if(retval < 0 && errno == EINTR)
+			continue;
+
+		if(retval < 0)
+			return -1;
+
+		bytes_written += (size_t)retval;
+
+	}
+
+	return (ssize_t)bytes_written;
+
+}
+
+#ifdef HAVE_LIBURING
+/**
+ * Wait for one write in flight to complete, and hand its buffer back
+ */
+static int dvd_output_reap(struct dvd_output *dvd_output) {
+
+	struct io_uring_cqe *cqe = NULL;
+	struct dvd_output_buffer *buffer = NULL;
+	int retval = 0;
+
+	retval = io_uring_wait_cqe(&dvd_output->ring, &cqe);
+	if(retval < 0) {
+		dvd_output->error = -retval;
+		return -1;
+	}
+
+	buffer = io_uring_cqe_get_data(cqe);
+
+	// A short write on a direct file means the filesystem is full
+	if(cqe->res < 0)
+		dvd_output->error = -cqe->res;
+	else if((size_t)cqe->res < buffer->bytes)
+		dvd_output->error = ENOSPC;
+
+	io_uring_cqe_seen(&dvd_output->ring, cqe);
+
+	buffer->busy = false;
+	buffer->bytes = 0;
+	dvd_output->in_flight--;
+
+	if(dvd_output->error)
+		return -1;
+
+	return 0;
+
+}
+#endif
+
+/**
+ * Write a full buffer at the current offset
+ */
+static int dvd_output_submit(struct dvd_output *dvd_output, struct dvd_output_buffer *buffer) {
+
+#ifdef HAVE_LIBURING
+	if(dvd_output->uring) {
+
+		struct io_uring_sqe *sqe = io_uring_get_sqe(&dvd_output->ring);
+
+		if(sqe == NULL) {
+			dvd_output->error = EBUSY;
+			return -1;
+		}
+
+		io_uring_prep_write(sqe, dvd_output->fd, buffer->data, (unsigned int)buffer->bytes, (unsigned long long)dvd_output->offset);
+		io_uring_sqe_set_data(sqe, buffer);
+
+		if(io_uring_submit(&dvd_output->ring) < 0) {
+			dvd_output->error = EIO;
+			return -1;
+		}
+
+		buffer->busy = true;
+		dvd_output->in_flight++;
+		dvd_output->offset += (off_t)buffer->bytes;
+
+		return 0;
+
+	}
+#endif
+
+	if(dvd_output_pwrite(dvd_output->fd, buffer->data, buffer->bytes, dvd_output->offset) < 0) {
+		dvd_output->error = errno;
+		return -1;
+	}
+
+	dvd_output->offset += (off_t)buffer->bytes;
+	buffer->bytes = 0;
+
+	return 0;
+
+}
+
+/**
+ * Move the offset past a hole in a regular file, giving back any space the
+ * filesystem has already allocated there
+ */
+static void dvd_output_hole(struct dvd_output *dvd_output, size_t bytes) {
+
+#ifdef FALLOC_FL_PUNCH_HOLE
+	// Nothing is allocated past the end of the file unless it has been
+	// preallocated, so it's fine if the filesystem can't punch holes
+	fallocate(dvd_output->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, dvd_output->offset, (off_t)bytes);
+#endif
+
+	dvd_output->offset += (off_t)bytes;
+
+}
+
+/**
+ * Wait until every write in flight has completed
+ */
+static int dvd_output_drain(struct dvd_output *dvd_output) {
+
+#ifdef HAVE_LIBURING
+	while(dvd_output->in_flight) {
+		if(dvd_output_reap(dvd_output) < 0)
+			return -1;
+	}
+#else
+	(void)dvd_output;
+#endif
+
+	return 0;
+
+}
+
+/**
+ * Only regular files can have holes, and seeking is ignored when appending
+ */
+static bool dvd_output_sparse(int fd) {
+
+	struct stat output_stat;
+
+	if(fd == -1 || fstat(fd, &output_stat) == -1 || !S_ISREG(output_stat.st_mode))
+		return false;
+
+	if(fcntl(fd, F_GETFL) & O_APPEND)
+		return false;
+
+	return true;
+
+}
+
+/**
+ * Block size of the filesystem the output is on, cloned ranges have to line
+ * up with it. Returns 0 if it isn't known.
+ */
+static size_t dvd_output_clone_block(int fd) {
+
+	struct stat output_stat;
+
+	if(fd == -1 || fstat(fd, &output_stat) == -1 || output_stat.st_blksize <= 0)
+		return 0;
+
+	return (size_t)output_stat.st_blksize;
+
+}
+
+void dvd_output_fd(struct dvd_output *dvd_output, int fd) {
+
+	memset(dvd_output, 0, sizeof(struct dvd_output));
+
+	dvd_output->fd = fd;
+	dvd_output->direct = false;
+	dvd_output->uring = false;
+	dvd_output->sparse = dvd_output_sparse(fd);
+	dvd_output->pipe = false;
+	dvd_output->zero_copy = false;
+	dvd_output->pipe_size = 0;
+	dvd_output->clone_block = dvd_output_clone_block(fd);
+	dvd_output->clone = dvd_output->sparse && dvd_output->clone_block;
+	dvd_output->copy_range = dvd_output->sparse;
+
+#ifdef __linux__
+	struct stat output_stat;
+	int pipe_size = 0;
+
+	// A bigger pipe means fewer, larger handoffs to the program reading it,
+	// it's fine if the system doesn't allow it
+	if(fd != -1 && fstat(fd, &output_stat) == 0 && S_ISFIFO(output_stat.st_mode)) {
+		dvd_output->pipe = true;
+		fcntl(fd, F_SETPIPE_SZ, DVD_OUTPUT_PIPE_SIZE);
+		pipe_size = fcntl(fd, F_GETPIPE_SZ);
+		dvd_output->pipe_size = pipe_size > 0 ? (size_t)pipe_size : 65536;
+	}
+#endif
+
+	// Something else may have written to the file already
+	if(dvd_output->sparse) {
+		dvd_output->offset = lseek(fd, 0, SEEK_CUR);
+		if(dvd_output->offset == -1) {
+			dvd_output->offset = 0;
+			dvd_output->sparse = false;
+		}
+	}
+
+}
+
+/**
+ * Open a file for writing, with flags added to the usual ones
+ */
+static bool dvd_output_open_flags(struct dvd_output *dvd_output, const char *filename, bool direct, int flags) {
+
+	uint32_t ix = 0;
+
+	dvd_output_fd(dvd_output, -1);
+
+	if(direct)
+		dvd_output->fd = open(filename, O_WRONLY | O_CREAT | O_DIRECT | flags, 0644);
+
+	// Not all filesystems can do direct I/O, so fall back to buffered
+	if(dvd_output->fd == -1)
+		dvd_output->fd = open(filename, O_WRONLY | O_CREAT | flags, 0644);
+	else
+		dvd_output->direct = true;
+
+	if(dvd_output->fd == -1)
+		return false;
+
+	dvd_output->sparse = dvd_output_sparse(dvd_output->fd);
+	dvd_output->clone_block = dvd_output_clone_block(dvd_output->fd);
+	dvd_output->clone = dvd_output->sparse && !dvd_output->direct && dvd_output->clone_block;
+	dvd_output->copy_range = dvd_output->sparse && !dvd_output->direct;
+
+	if(!dvd_output->direct)
+		return true;
+
+	dvd_output->buffers = DVD_OUTPUT_QUEUE_DEPTH;
+	dvd_output->buffer = calloc(dvd_output->buffers, sizeof(struct dvd_output_buffer));
+	if(dvd_output->buffer == NULL) {
+		close(dvd_output->fd);
+		return false;
+	}
+
+	for(ix = 0; ix < dvd_output->buffers; ix++) {
+		if(posix_memalign((void **)&dvd_output->buffer[ix].data, DVD_OUTPUT_ALIGN, DVD_OUTPUT_BUFFER_SIZE) != 0) {
+			dvd_output->buffer[ix].data = NULL;
+			dvd_output_close(dvd_output);
+			return false;
+		}
+	}
+
+#ifdef HAVE_LIBURING
+	// Kernels without io_uring, or with it disabled, use pwrite()
+	if(io_uring_queue_init(DVD_OUTPUT_QUEUE_DEPTH, &dvd_output->ring, 0) == 0)
+		dvd_output->uring = true;
+#endif
+
+	return true;
+
+}
+
+bool dvd_output_open(struct dvd_output *dvd_output, const char *filename, bool direct) {
+
+	return dvd_output_open_flags(dvd_output, filename, direct, O_TRUNC);
+
+}
+
+bool dvd_output_resume(struct dvd_output *dvd_output, const char *filename, bool direct, off_t offset) {
+
+	if(!dvd_output_open_flags(dvd_output, filename, direct, 0))
+		return false;
+
+	// Anything past the offset wasn't finished, so drop it
+	if(!dvd_output->sparse || ftruncate(dvd_output->fd, offset) == -1 || lseek(dvd_output->fd, offset, SEEK_SET) == -1) {
+		dvd_output_close(dvd_output);
+		return false;
+	}
+
+	dvd_output->offset = offset;
+
+	return true;
+
+}
+
+int dvd_output_reserve(struct dvd_output *dvd_output, off_t bytes) {
+
+	int retval = 0;
+
+	if(!dvd_output->sparse || bytes <= dvd_output->offset)
+		return 0;
+
+#ifdef __linux__
+	// Use fallocate() directly, posix_fallocate() falls back to writing
+	// zeros on filesystems that don't support it
+	if(fallocate(dvd_output->fd, 0, dvd_output->offset, bytes - dvd_output->offset) == -1)
+		retval = errno;
+#else
+	retval = posix_fallocate(dvd_output->fd, dvd_output->offset, bytes - dvd_output->offset);
+#endif
+
+	if(retval == 0 || retval == EOPNOTSUPP || retval == ENOSYS || retval == EINVAL)
+		return 0;
+
+	dvd_output->error = retval;
+
+	return -1;
+
+}
+
+ssize_t dvd_output_write(struct dvd_output *dvd_output, const unsigned char *data, size_t bytes) {
+
+	if(dvd_output->error)
+		return -1;
+
+	if(!dvd_output->direct) {
+
+		if(dvd_output_plain_write(dvd_output->fd, data, bytes, dvd_output->zero_copy) < 0) {
+			dvd_output->error = errno;
+			return -1;
+		}
+
+		dvd_output->offset += (off_t)bytes;
+
+		return (ssize_t)bytes;
+
+	}
+
+	struct dvd_output_buffer *buffer = NULL;
+	size_t bytes_queued = 0;
+	size_t bytes_copied = 0;
+
+	while(bytes_queued < bytes) {
+
+		buffer = &dvd_output->buffer[dvd_output->current];
+
+#ifdef HAVE_LIBURING
+		// Wait for the oldest write to finish before reusing its buffer
+		while(buffer->busy) {
+			if(dvd_output_reap(dvd_output) < 0)
+				return -1;
+		}
+#endif
+
+		bytes_copied = bytes - bytes_queued;
+		if(bytes_copied > DVD_OUTPUT_BUFFER_SIZE - buffer->bytes)
+			bytes_copied = DVD_OUTPUT_BUFFER_SIZE - buffer->bytes;
+
+		memcpy(buffer->data + buffer->bytes, data + bytes_queued, bytes_copied);
+		buffer->bytes += bytes_copied;
+		bytes_queued += bytes_copied;
+
+		if(buffer->bytes == DVD_OUTPUT_BUFFER_SIZE) {
+			if(dvd_output_submit(dvd_output, buffer) < 0)
+				return -1;
+			dvd_output->current = (dvd_output->current + 1) % dvd_output->buffers;
+		}
+
+	}
+
+	return (ssize_t)bytes;
+
+}
+
+ssize_t dvd_output_skip(struct dvd_output *dvd_output, size_t bytes) {
+
+	static const unsigned char zeros[DVD_OUTPUT_ALIGN];
+	size_t bytes_skipped = 0;
+	size_t bytes_zeroed = 0;
+
+	if(dvd_output->error)
+		return -1;
+
+	if(!dvd_output->direct) {
+
+		if(!dvd_output->sparse) {
+			while(bytes_skipped < bytes) {
+				bytes_zeroed = bytes - bytes_skipped;
+				if(bytes_zeroed > DVD_OUTPUT_ALIGN)
+					bytes_zeroed = DVD_OUTPUT_ALIGN;
+				if(dvd_output_write(dvd_output, zeros, bytes_zeroed) < 0)
+					return -1;
+				bytes_skipped += bytes_zeroed;
+			}
+			return (ssize_t)bytes;
+		}
+
+		if(lseek(dvd_output->fd, (off_t)bytes, SEEK_CUR) == -1) {
+			dvd_output->error = errno;
+			return -1;
+		}
+
+		dvd_output_hole(dvd_output, bytes);
+
+		return (ssize_t)bytes;
+
+	}
+
+	struct dvd_output_buffer *buffer = NULL;
+
+	while(bytes_skipped < bytes) {
+
+		buffer = &dvd_output->buffer[dvd_output->current];
+
+#ifdef HAVE_LIBURING
+		while(buffer->busy) {
+			if(dvd_output_reap(dvd_output) < 0)
+				return -1;
+		}
+#endif
+
+		// A whole buffer can be left out if nothing has been gathered
+		// into the current one yet, the offset stays aligned
+		if(dvd_output->sparse && buffer->bytes == 0 && bytes - bytes_skipped >= DVD_OUTPUT_BUFFER_SIZE) {
+			dvd_output_hole(dvd_output, DVD_OUTPUT_BUFFER_SIZE);
+			bytes_skipped += DVD_OUTPUT_BUFFER_SIZE;
+			continue;
+		}
+
+		bytes_zeroed = bytes - bytes_skipped;
+		if(bytes_zeroed > DVD_OUTPUT_BUFFER_SIZE - buffer->bytes)
+			bytes_zeroed = DVD_OUTPUT_BUFFER_SIZE - buffer->bytes;
+
+		memset(buffer->data + buffer->bytes, '\0', bytes_zeroed);
+		buffer->bytes += bytes_zeroed;
+		bytes_skipped += bytes_zeroed;
+
+		if(buffer->bytes == DVD_OUTPUT_BUFFER_SIZE) {
+			if(dvd_output_submit(dvd_output, buffer) < 0)
+				return -1;
+			dvd_output->current = (dvd_output->current + 1) % dvd_output->buffers;
+		}
+
+	}
+
+	return (ssize_t)bytes;
+
+}
+
+ssize_t dvd_output_write_blocks(struct dvd_output *dvd_output, const unsigned char *buffer, uint64_t blocks, const bool *bad) {
+
+	uint64_t block = 0;
+	uint64_t run = 0;
+	ssize_t retval = 0;
+
+	if(bad == NULL)
+		return dvd_output_write(dvd_output, buffer, blocks * DVD_VIDEO_LB_LEN);
+
+	// Write each run of good blocks in one go, and skip the bad ones
+	while(block < blocks) {
+
+		run = 1;
+		while(block + run < blocks && bad[block + run] == bad[block])
+			run++;
+
+		if(bad[block])
+			retval = dvd_output_skip(dvd_output, run * DVD_VIDEO_LB_LEN);
+		else
+			retval = dvd_output_write(dvd_output, buffer + (block * DVD_VIDEO_LB_LEN), run * DVD_VIDEO_LB_LEN);
+
+		if(retval < 0)
+			return -1;
+
+		block += run;
+
+	}
+
+	return (ssize_t)(blocks * DVD_VIDEO_LB_LEN);
+
+}
+
+bool dvd_output_zero_copy(struct dvd_output *dvd_output) {
+
+	if(!dvd_output->pipe)
+		return false;
+
+	dvd_output->zero_copy = true;
+
+	return true;
+
+}
+
+size_t dvd_output_unread(struct dvd_output *dvd_output) {
+
+	int unread = 0;
+
+	if(!dvd_output->pipe)
+		return 0;
+
+	if(ioctl(dvd_output->fd, FIONREAD, &unread) == -1 || unread < 0)
+		return 0;
+
+	return (size_t)unread;
+
+}
+
+bool dvd_output_wait(struct dvd_output *dvd_output) {
+
+	struct pollfd output_pollfd;
+	struct timespec ts;
+
+	output_pollfd.fd = dvd_output->fd;
+	output_pollfd.events = 0;
+	output_pollfd.revents = 0;
+
+	if(poll(&output_pollfd, 1, 0) > 0 && (output_pollfd.revents & (POLLERR | POLLHUP)))
+		return false;
+
+	ts.tv_sec = 0;
+	ts.tv_nsec = 100000;
+	nanosleep(&ts, NULL);
+
+	return true;
+
+}
+
+int dvd_output_seek(struct dvd_output *dvd_output, off_t offset) {
+
+	if(dvd_output->error)
+		return -1;
+
+	if(offset == dvd_output->offset)
+		return 0;
+
+	if(!dvd_output->sparse || dvd_output->direct) {
+		dvd_output->error = ESPIPE;
+		return -1;
+	}
+
+	if(lseek(dvd_output->fd, offset, SEEK_SET) == -1) {
+		dvd_output->error = errno;
+		return -1;
+	}
+
+	dvd_output->offset = offset;
+
+	return 0;
+
+}
+
+ssize_t dvd_output_splice(struct dvd_output *dvd_output, int fd, off_t offset, size_t bytes) {
+
+	size_t bytes_written = 0;
+	ssize_t retval = 0;
+
+	if(dvd_output->error)
+		return -1;
+
+#ifdef __linux__
+	loff_t splice_offset = offset;
+
+	if(dvd_output->pipe) {
+
+		while(bytes_written < bytes) {
+
+			retval = splice(fd, &splice_offset, dvd_output->fd, NULL, bytes - bytes_written, SPLICE_F_MOVE | SPLICE_F_MORE);
+
+			if(retval < 0 && errno == EINTR)
+				continue;
+
+			// The source file is shorter than it should be
+			if(retval == 0)
+				errno = EIO;
+
+			if(retval <= 0) {
+				dvd_output->error = errno;
+				return -1;
+			}
+
+			bytes_written += (size_t)retval;
+
+		}
+
+		dvd_output->offset += (off_t)bytes;
+
+		return (ssize_t)bytes;
+
+	}
+
+	// Share the extents of the source file, this needs both offsets and the
+	// length to be aligned to the filesystem's block size. Ranges that
+	// aren't are copied instead, and once an aligned one fails, cloning
+	// isn't tried again.
+	struct file_clone_range clone_range;
+
+	if(dvd_output->clone && (uint64_t)offset % dvd_output->clone_block == 0 && (uint64_t)dvd_output->offset % dvd_output->clone_block == 0 && bytes % dvd_output->clone_block == 0) {
+
+		clone_range.src_fd = fd;
+		clone_range.src_offset = (uint64_t)offset;
+		clone_range.src_length = (uint64_t)bytes;
+		clone_range.dest_offset = (uint64_t)dvd_output->offset;
+
+		if(ioctl(dvd_output->fd, FICLONERANGE, &clone_range) == 0 && lseek(dvd_output->fd, dvd_output->offset + (off_t)bytes, SEEK_SET) != -1) {
+			dvd_output->offset += (off_t)bytes;
+			return (ssize_t)bytes;
+		}
+
+		dvd_output->clone = false;
+
+	}
+
+	// Have the kernel do the copy, using the file position of the output
+	while(dvd_output->copy_range && bytes_written < bytes) {
+
+		retval = copy_file_range(fd, &splice_offset, dvd_output->fd, NULL, bytes - bytes_written, 0);
+
+		if(retval < 0 && errno == EINTR)
+			continue;
+
+		// Different filesystems on older kernels, or not supported at all,
+		// copy the rest by hand
+		if(retval < 0 && (errno == EXDEV || errno == ENOSYS || errno == EOPNOTSUPP || errno == EINVAL)) {
+			dvd_output->copy_range = false;
+			break;
+		}
+
+		if(retval == 0)
+			errno = EIO;
+
+		if(retval <= 0) {
+			dvd_output->error = errno;
+			return -1;
+		}
+
+		bytes_written += (size_t)retval;
+		dvd_output->offset += (off_t)retval;
+
+	}
+
+	if(bytes_written == bytes)
+		return (ssize_t)bytes;
+#endif
+
+	unsigned char buffer[DVD_OUTPUT_ALIGN * 16];
+	size_t bytes_read = 0;
+
+	while(bytes_written < bytes) {
+
+		bytes_read = bytes - bytes_written;
+		if(bytes_read > sizeof(buffer))
+			bytes_read = sizeof(buffer);
+
+		retval = pread(fd, buffer, bytes_read, offset + (off_t)bytes_written);
+
+		if(retval < 0 && errno == EINTR)
+			continue;
+
+		if(retval == 0)
+			errno = EIO;
+
+		if(retval <= 0) {
+			dvd_output->error = errno;
+			return -1;
+		}
+
+		if(dvd_output_write(dvd_output, buffer, (size_t)retval) < 0)
+			return -1;
+
+		bytes_written += (size_t)retval;
+
+	}
+
+	return (ssize_t)bytes;
+
+}
+
+int dvd_output_sync(struct dvd_output *dvd_output) {
+
+	struct dvd_output_buffer *buffer = NULL;
+	size_t aligned_bytes = 0;
+
+	if(dvd_output->error)
+		return -1;
+
+	if(dvd_output->direct && dvd_output->buffer != NULL) {
+
+		if(dvd_output_drain(dvd_output) < 0)
+			return -1;
+
+		// The current buffer is written out now as far as it can be, and
+		// again once it fills up, since the offset only moves a buffer at a
+		// time
+		buffer = &dvd_output->buffer[dvd_output->current];
+		aligned_bytes = buffer->bytes - (buffer->bytes % DVD_OUTPUT_ALIGN);
+
+		if(aligned_bytes && dvd_output_pwrite(dvd_output->fd, buffer->data, aligned_bytes, dvd_output->offset) < 0) {
+			dvd_output->error = errno;
+			return -1;
+		}
+
+		if(aligned_bytes < buffer->bytes)
+			return 1;
+
+	}
+
+	if(fdatasync(dvd_output->fd) == -1) {
+		dvd_output->error = errno;
+		return -1;
+	}
+
+	return 0;
+
+}
+
+int dvd_output_close(struct dvd_output *dvd_output) {
+
+	uint32_t ix = 0;
+	struct dvd_output_buffer *buffer = NULL;
+	size_t aligned_bytes = 0;
+	int flags = 0;
+
+	if(dvd_output->direct && dvd_output->buffer != NULL && dvd_output->error == 0) {
+
+		buffer = &dvd_output->buffer[dvd_output->current];
+
+		dvd_output_drain(dvd_output);
+
+		// Write the aligned part of what is left directly, and the tail
+		// with O_DIRECT turned off, since it may not be a full block
+		aligned_bytes = buffer->bytes - (buffer->bytes % DVD_OUTPUT_ALIGN);
+
+		if(!dvd_output->error && aligned_bytes) {
+			if(dvd_output_pwrite(dvd_output->fd, buffer->data, aligned_bytes, dvd_output->offset) < 0)
+				dvd_output->error = errno;
+			else
+				dvd_output->offset += (off_t)aligned_bytes;
+		}
+
+		if(!dvd_output->error && buffer->bytes > aligned_bytes) {
+			flags = fcntl(dvd_output->fd, F_GETFL);
+			fcntl(dvd_output->fd, F_SETFL, flags & ~O_DIRECT);
+			if(dvd_output_pwrite(dvd_output->fd, buffer->data + aligned_bytes, buffer->bytes - aligned_bytes, dvd_output->offset) < 0)
+				dvd_output->error = errno;
+			else
+				dvd_output->offset += (off_t)(buffer->bytes - aligned_bytes);
+		}
+
+		buffer->bytes = 0;
+
+	}
+
+	dvd_output_drain(dvd_output);
+
+	// Pages handed to the pipe still belong to the caller's buffers, so
+	// wait for the other end to read them, unless it has gone away
+	while(dvd_output->zero_copy && dvd_output_unread(dvd_output) > 0) {
+		if(!dvd_output_wait(dvd_output))
+			break;
+	}
+
+	// If the output ends on a hole, the file still has to be the full size
+	if(dvd_output->sparse && dvd_output->fd != -1 && dvd_output->error == 0) {
+		struct stat output_stat;
+		if(fstat(dvd_output->fd, &output_stat) == 0 && output_stat.st_size < dvd_output->offset && ftruncate(dvd_output->fd, dvd_output->offset) == -1)
+			dvd_output->error = errno;
+	}
+
+#ifdef HAVE_LIBURING
+	if(dvd_output->uring)
+		io_uring_queue_exit(&dvd_output->ring);
+	dvd_output->uring = false;
+#endif
+
+	if(dvd_output->buffer != NULL) {
+		for(ix = 0; ix < dvd_output->buffers; ix++)
+			free(dvd_output->buffer[ix].data);
+		free(dvd_output->buffer);
+		dvd_output->buffer = NULL;
+	}
+
+	if(dvd_output->fd > 2 && close(dvd_output->fd) == -1 && dvd_output->error == 0)
+		dvd_output->error = errno;
+
+	dvd_output->fd = -1;
+
+	if(dvd_output->error)
+		return -1;
+
+	return 0;
+
+}
@@ -0,0 +1,225 @@
+#ifndef DVD_INFO_OUTPUT_H
+#define DVD_INFO_OUTPUT_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <time.h>
+#include "config.h"
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+#ifndef DVD_VIDEO_LB_LEN
+#define DVD_VIDEO_LB_LEN 2048
+#endif
+
+// O_DIRECT needs buffers, lengths and offsets aligned to the logical block
+// size of the output device. 4 KiB covers both 512 byte and 4Kn drives.
+#define DVD_OUTPUT_ALIGN 4096
+
+// Size of each direct write, and how many can be in flight at once
+#define DVD_OUTPUT_BUFFER_SIZE 1048576
+#define DVD_OUTPUT_QUEUE_DEPTH 4
+
+// Size to grow pipes to, the default of 64 KiB means a wakeup of the
+// program on the other end for every 32 blocks
+#define DVD_OUTPUT_PIPE_SIZE 1048576
+
+/**
+ * Output files for copying DVD data
+ *
+ * By default, writes are plain buffered write() calls. Copying a track or a
+ * full disc pushes gigabytes of VOB data through the page cache that nothing
+ * is ever going to read again though, and on a busy host that evicts data
+ * that *is* being used.
+ *
+ * With direct output, the file is opened with O_DIRECT so writes go around
+ * the page cache. Data is gathered into aligned buffers, and full buffers
+ * are submitted through io_uring with several writes in flight at once. If
+ * dvd_info was built without liburing, or the kernel doesn't allow io_uring,
+ * each buffer is written with pwrite() instead. If the filesystem doesn't
+ * support O_DIRECT at all (tmpfs, for example), it falls back to buffered
+ * writes.
+ *
+ * Blocks that couldn't be read from the DVD don't have to be written at all.
+ * When the output is a regular file, they are skipped over with lseek()
+ * and any space already allocated there is released with
+ * FALLOC_FL_PUNCH_HOLE, leaving a sparse hole that reads back as zeros.
+ * With direct output, holes are made a whole buffer at a time, and shorter
+ * runs are written as zeros, since writes have to stay aligned. Pipes and
+ * other outputs that can't seek always get the zeros.
+ *
+ * When the output is a pipe (dvd_copy -o - | ffmpeg ...), the pipe is made
+ * larger, and with zero copy, writes hand the pages of the buffers to the
+ * pipe with vmsplice() instead of copying them into the kernel. Sectors that
+ * can be read straight from an unencrypted source file are moved into the
+ * pipe with splice(), and never pass through userspace at all. When the
+ * output is a regular file, they are cloned or copied in the kernel
+ * instead, see dvd_output_splice().
+ */
+
+struct dvd_output_buffer {
+	unsigned char *data;
+	size_t bytes;
+	bool busy;
+};
+
+struct dvd_output {
+	int fd;
+	bool direct;
+	bool uring;
+	bool sparse;
+	bool pipe;
+	bool zero_copy;
+	size_t pipe_size;
+	bool clone;
+	size_t clone_block;
+	bool copy_range;
+	off_t offset;
+	int error;
+	uint32_t buffers;
+	uint32_t current;
+	uint32_t in_flight;
+	struct dvd_output_buffer *buffer;
+#ifdef HAVE_LIBURING
+	struct io_uring ring;
+#endif
+};
+
+/**
+ * Create (or truncate) a file for writing.
+ *
+ * Returns false if the file can't be opened, or buffers can't be allocated.
+ */
+bool dvd_output_open(struct dvd_output *dvd_output, const char *filename, bool direct);
+
+/**
+ * Open a file to pick up writing where an earlier copy left off, see
+ * dvd_journal.h. Anything in the file after offset is dropped. With direct
+ * output, offset must be aligned to DVD_OUTPUT_ALIGN.
+ *
+ * Returns false if the file can't be opened, or isn't a regular file.
+ */
+bool dvd_output_resume(struct dvd_output *dvd_output, const char *filename, bool direct, off_t offset);
+
+/**
+ * Use a file descriptor that is already open, such as stdout. Writes are
+ * always plain write() calls.
+ */
+void dvd_output_fd(struct dvd_output *dvd_output, int fd);
+
+/**
+ * Allocate the final size of the file up front, so that a full disk shows
+ * up right away instead of partway through reading a disc, and so that the
+ * filesystem can lay the file out in large contiguous extents.
+ *
+ * Does nothing for outputs that aren't regular files, or on filesystems that
+ * can't preallocate.
+ *
+ * Returns 0 on success, or -1 if the space can't be allocated, with the
+ * error set in dvd_output->error.
+ */
+int dvd_output_reserve(struct dvd_output *dvd_output, off_t bytes);
+
+/**
+ * Write bytes to the output. With direct output, they may only be queued,
+ * and errors from writes in flight show up on a later call.
+ *
+ * Returns the number of bytes taken, or -1 on error, with the error set in
+ * dvd_output->error.
+ */
+ssize_t dvd_output_write(struct dvd_output *dvd_output, const unsigned char *data, size_t bytes);
+
+/**
+ * Write a run of DVD blocks to the output, leaving a hole for each block
+ * that is set in bad. If bad is NULL, every block is written.
+ *
+ * Returns the number of bytes taken, or -1 on error.
+ */
+ssize_t dvd_output_write_blocks(struct dvd_output *dvd_output, const unsigned char *buffer, uint64_t blocks, const bool *bad);
+
+/**
+ * Leave a hole of bytes in the output, see above.
+ *
+ * Returns the number of bytes skipped, or -1 on error.
+ */
+ssize_t dvd_output_skip(struct dvd_output *dvd_output, size_t bytes);
+
+/**
+ * Let writes to a pipe hand over the pages of the caller's buffers with
+ * vmsplice() instead of copying them.
+ *
+ * The pipe keeps pointing at the pages until the other end reads them, so
+ * a buffer must not be changed or freed until dvd_output_unread() is no
+ * more than the number of bytes written after it. Closing the output waits
+ * for the pipe to be drained.
+ *
+ * Returns false if the output isn't a pipe.
+ */
+bool dvd_output_zero_copy(struct dvd_output *dvd_output);
+
+/**
+ * Number of bytes in the pipe that the other end hasn't read yet.
+ */
+size_t dvd_output_unread(struct dvd_output *dvd_output);
+
+/**
+ * Wait a moment for the other end of the pipe to read from it.
+ *
+ * Returns false if the other end has gone away.
+ */
+bool dvd_output_wait(struct dvd_output *dvd_output);
+
+/**
+ * Move to offset in a regular file, so that parts of it can be written out
+ * of order. Writes that are queued for direct output have to go to the
+ * offsets they were queued for, so direct output can't seek.
+ *
+ * Returns 0 on success, or -1 if the output can't seek.
+ */
+int dvd_output_seek(struct dvd_output *dvd_output, off_t offset);
+
+/**
+ * Write bytes straight from another file, starting at offset.
+ *
+ * Pipes get them with splice(). Regular files first try to share the
+ * source's extents with FICLONERANGE, which is instant on filesystems with
+ * reflinks (btrfs, XFS) when both files are on the same one, and the
+ * offsets line up with its block size. Otherwise copy_file_range() lets the
+ * kernel copy (or share) the data without passing it through userspace. If
+ * neither works, the bytes are read and written as usual.
+ *
+ * Returns the number of bytes taken, or -1 on error.
+ */
+ssize_t dvd_output_splice(struct dvd_output *dvd_output, int fd, off_t offset, size_t bytes);
+
+/**
+ * Make sure everything written so far is on disk.
+ *
+ * Returns 0 once it is, or -1 on error. With direct output, returns 1 if
+ * what is left of the data ends partway through an aligned block, so it
+ * can't be written out yet, try again after the next write.
+ */
+int dvd_output_sync(struct dvd_output *dvd_output);
+
+/**
+ * Flush everything that is queued, and close the file.
+ *
+ * Returns 0 on success, or -1 if any write failed.
+ */
+int dvd_output_close(struct dvd_output *dvd_output);
+
+#endif
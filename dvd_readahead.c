@@ -0,0 +1,123 @@
+#define _GNU_SOURCE
+#include "dvd_readahead.h"
+
+/**
+ * Functions used to read ahead of sequential copies, and time them
+ */
+
+bool dvd_readahead_open(struct dvd_readahead *dvd_readahead, const char *device_filename, uint32_t kbs) {
+
+	struct stat device_stat;
+
+	memset(dvd_readahead, 0, sizeof(struct dvd_readahead));
+	dvd_readahead->fd = -1;
+	clock_gettime(CLOCK_MONOTONIC, &dvd_readahead->start);
+
+	if(kbs == 0)
+		return true;
+
+	if(stat(device_filename, &device_stat) == -1 || !S_ISBLK(device_stat.st_mode))
+		return true;
+
+#ifdef __linux__
+
+	dvd_readahead->fd = open(device_filename, O_RDONLY | O_NONBLOCK);
+	if(dvd_readahead->fd == -1)
+		return false;
+
+	// Readahead of a block device is in 512 byte sectors
+	if(ioctl(dvd_readahead->fd, BLKRAGET, &dvd_readahead->saved_sectors) == -1) {
+		close(dvd_readahead->fd);
+		dvd_readahead->fd = -1;
+		return false;
+	}
+
+	dvd_readahead->sectors = (unsigned long)kbs * 2;
+
+	if(dvd_readahead->sectors == dvd_readahead->saved_sectors)
+		return true;
+
+	if(ioctl(dvd_readahead->fd, BLKRASET, dvd_readahead->sectors) == -1) {
+		dvd_readahead->sectors = dvd_readahead->saved_sectors;
+		return false;
+	}
+
+	dvd_readahead->changed = true;
+
+	return true;
+
+#else
+
+	return false;
+
+#endif
+
+}
+
+void dvd_readahead_sequential(int fd) {
+
+#ifdef POSIX_FADV_SEQUENTIAL
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#else
+	(void)fd;
+#endif
+
+}
+
+void dvd_readahead_file(struct dvd_readahead *dvd_readahead, int fd, off_t offset, uint64_t blocks) {
+
+	if(fd == -1 || blocks == 0)
+		return;
+
+#ifdef __linux__
+	readahead(fd, offset, (size_t)(blocks * DVD_VIDEO_LB_LEN));
+#elif defined(POSIX_FADV_WILLNEED)
+	posix_fadvise(fd, offset, (off_t)(blocks * DVD_VIDEO_LB_LEN), POSIX_FADV_WILLNEED);
+#endif
+
+	dvd_readahead->hints++;
+
+}
+
+void dvd_readahead_update(struct dvd_readahead *dvd_readahead, uint64_t blocks) {
+
+	dvd_readahead->blocks += blocks;
+
+}
+
+double dvd_readahead_seconds(struct dvd_readahead *dvd_readahead) {
+
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (double)(now.tv_sec - dvd_readahead->start.tv_sec) + (now.tv_nsec - dvd_readahead->start.tv_nsec) / 1000000000.0;
+
+}
+
+double dvd_readahead_mbs(struct dvd_readahead *dvd_readahead) {
+
+	double seconds = dvd_readahead_seconds(dvd_readahead);
+
+	if(seconds <= 0)
+		return 0;
+
+	return (double)(dvd_readahead->blocks * DVD_VIDEO_LB_LEN) / 1048576.0 / seconds;
+
+}
+
+void dvd_readahead_close(struct dvd_readahead *dvd_readahead) {
+
+	if(dvd_readahead->fd == -1)
+		return;
+
+#ifdef __linux__
+	if(dvd_readahead->changed)
+		ioctl(dvd_readahead->fd, BLKRASET, dvd_readahead->saved_sectors);
+#endif
+
+	close(dvd_readahead->fd);
+	dvd_readahead->fd = -1;
+	dvd_readahead->changed = false;
+
+}
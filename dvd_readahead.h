@@ -0,0 +1,102 @@
+#ifndef DVD_INFO_READAHEAD_H
+#define DVD_INFO_READAHEAD_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
+#ifndef DVD_VIDEO_LB_LEN
+#define DVD_VIDEO_LB_LEN 2048
+#endif
+
+// Default readahead for --readahead, in KiB
+#define DVD_READAHEAD_KBS 4096
+
+// Range that --readahead can be set to, in KiB
+#define DVD_READAHEAD_KBS_MIN 128
+#define DVD_READAHEAD_KBS_MAX 65536
+
+/**
+ * Readahead for sequential copies, and how fast they read.
+ *
+ * The kernel reads ahead of a program on its own, but the default window
+ * of an optical drive is small (128 KiB on most systems), so reads that
+ * go through the page cache reach the drive as small requests. For the time
+ * of a copy, the readahead of the drive is raised with BLKRASET, and put
+ * back to what it was when the copy is done. Changing it needs
+ * CAP_SYS_ADMIN, and without it the drive is left alone.
+ *
+ * Images and directories are regular files, and their readahead is per
+ * open file instead. Those are marked POSIX_FADV_SEQUENTIAL, and since a
+ * track can jump from one part of the image to another, the start of the
+ * next extent to copy is asked for with readahead(2) before it's reached,
+ * see dvd_readahead_file().
+ *
+ * To see what it changes, the time spent copying and the blocks read are
+ * kept, so the throughput can be compared with and without it.
+ */
+
+struct dvd_readahead {
+	int fd;
+	bool changed;
+	unsigned long saved_sectors;
+	unsigned long sectors;
+	uint64_t hints;
+	uint64_t blocks;
+	struct timespec start;
+};
+
+/**
+ * Start the clock on a copy. If device_filename is a drive and kbs isn't
+ * 0, its readahead is set to kbs.
+ *
+ * Returns false if kbs was given and the readahead couldn't be changed.
+ */
+bool dvd_readahead_open(struct dvd_readahead *dvd_readahead, const char *device_filename, uint32_t kbs);
+
+/**
+ * Mark a file as being read sequentially, so the kernel reads further
+ * ahead of it.
+ */
+void dvd_readahead_sequential(int fd);
+
+/**
+ * Ask the kernel to start reading part of a file into the page cache, so
+ * it's there by the time it's needed.
+ */
+void dvd_readahead_file(struct dvd_readahead *dvd_readahead, int fd, off_t offset, uint64_t blocks);
+
+/**
+ * Add blocks that have been read to the throughput.
+ */
+void dvd_readahead_update(struct dvd_readahead *dvd_readahead, uint64_t blocks);
+
+/**
+ * Seconds since dvd_readahead_open()
+ */
+double dvd_readahead_seconds(struct dvd_readahead *dvd_readahead);
+
+/**
+ * Throughput of the blocks read so far, in MB/s
+ */
+double dvd_readahead_mbs(struct dvd_readahead *dvd_readahead);
+
+/**
+ * Put the readahead of the drive back
+ */
+void dvd_readahead_close(struct dvd_readahead *dvd_readahead);
+
+#endif
@@ -0,0 +1,195 @@
+#include "dvd_ring.h"
+
+/**
+ * Functions used to pass block buffers between a reader and a writer thread
+ */
+
+static uint64_t dvd_ring_nsecs(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+
+}
+
+/**
+ * Back off while waiting on the other side. Spin on the first few tries,
+ * since a slot is usually only a moment away, then sleep for longer and
+ * longer, up to a millisecond.
+ */
+static void dvd_ring_wait(uint32_t tries) {
+
+	if(tries < 64)
+		return;
+
+	struct timespec ts;
+	ts.tv_sec = 0;
+	ts.tv_nsec = 1000 << (tries < 74 ? tries - 64 : 10);
+
+	nanosleep(&ts, NULL);
+
+}
+
+bool dvd_ring_init(struct dvd_ring *dvd_ring, uint32_t slots, uint64_t slot_blocks) {
+
+	uint32_t ix = 0;
+
+	dvd_ring->slots = slots;
+	dvd_ring->slot_blocks = slot_blocks;
+	atomic_init(&dvd_ring->head, 0);
+	atomic_init(&dvd_ring->tail, 0);
+	dvd_ring->read = 0;
+	dvd_ring->hold = false;
+	atomic_init(&dvd_ring->finished, false);
+	atomic_init(&dvd_ring->aborted, false);
+	dvd_ring->reader_stall_nsecs = 0;
+	dvd_ring->writer_stall_nsecs = 0;
+
+	dvd_ring->slot = calloc(slots, sizeof(struct dvd_ring_slot));
+	if(dvd_ring->slot == NULL)
+		return false;
+
+	for(ix = 0; ix < slots; ix++) {
+
+		dvd_ring->slot[ix].buffer = calloc(slot_blocks, DVD_VIDEO_LB_LEN);
+		dvd_ring->slot[ix].bad = calloc(slot_blocks, sizeof(bool));
+		dvd_ring->slot[ix].source_fd = -1;
+
+		if(dvd_ring->slot[ix].buffer == NULL || dvd_ring->slot[ix].bad == NULL) {
+			dvd_ring_free(dvd_ring);
+			return false;
+		}
+
+	}
+
+	return true;
+
+}
+
+void dvd_ring_free(struct dvd_ring *dvd_ring) {
+
+	uint32_t ix = 0;
+
+	if(dvd_ring->slot == NULL)
+		return;
+
+	for(ix = 0; ix < dvd_ring->slots; ix++) {
+		free(dvd_ring->slot[ix].buffer);
+		free(dvd_ring->slot[ix].bad);
+	}
+
+	free(dvd_ring->slot);
+	dvd_ring->slot = NULL;
+
+}
+
+struct dvd_ring_slot *dvd_ring_write_slot(struct dvd_ring *dvd_ring) {
+
+	uint64_t head = atomic_load_explicit(&dvd_ring->head, memory_order_relaxed);
+	uint64_t start = 0;
+	uint32_t tries = 0;
+
+	// Ring is full until the writer drains a slot
+	while(head - atomic_load_explicit(&dvd_ring->tail, memory_order_acquire) == dvd_ring->slots) {
+
+		if(atomic_load_explicit(&dvd_ring->aborted, memory_order_acquire))
+			return NULL;
+
+		if(tries == 0)
+			start = dvd_ring_nsecs();
+
+		dvd_ring_wait(tries++);
+
+	}
+
+	if(tries)
+		dvd_ring->reader_stall_nsecs += dvd_ring_nsecs() - start;
+
+	if(atomic_load_explicit(&dvd_ring->aborted, memory_order_acquire))
+		return NULL;
+
+	return &dvd_ring->slot[head % dvd_ring->slots];
+
+}
+
+void dvd_ring_push(struct dvd_ring *dvd_ring) {
+
+	atomic_fetch_add_explicit(&dvd_ring->head, 1, memory_order_release);
+
+}
+
+void dvd_ring_finish(struct dvd_ring *dvd_ring) {
+
+	atomic_store_explicit(&dvd_ring->finished, true, memory_order_release);
+
+}
+
+struct dvd_ring_slot *dvd_ring_read_slot(struct dvd_ring *dvd_ring) {
+
+	uint64_t tail = dvd_ring->read;
+	uint64_t start = 0;
+	uint32_t tries = 0;
+
+	// Ring is empty until the reader fills a slot
+	while(atomic_load_explicit(&dvd_ring->head, memory_order_acquire) == tail) {
+
+		// Check the head once more after seeing the finished flag, so a
+		// slot pushed right before finishing isn't lost
+		if(atomic_load_explicit(&dvd_ring->finished, memory_order_acquire) && atomic_load_explicit(&dvd_ring->head, memory_order_acquire) == tail) {
+			if(tries)
+				dvd_ring->writer_stall_nsecs += dvd_ring_nsecs() - start;
+			return NULL;
+		}
+
+		if(tries == 0)
+			start = dvd_ring_nsecs();
+
+		dvd_ring_wait(tries++);
+
+	}
+
+	if(tries)
+		dvd_ring->writer_stall_nsecs += dvd_ring_nsecs() - start;
+
+	return &dvd_ring->slot[tail % dvd_ring->slots];
+
+}
+
+void dvd_ring_pop(struct dvd_ring *dvd_ring) {
+
+	dvd_ring->read++;
+
+	if(!dvd_ring->hold)
+		atomic_store_explicit(&dvd_ring->tail, dvd_ring->read, memory_order_release);
+
+}
+
+void dvd_ring_hold(struct dvd_ring *dvd_ring) {
+
+	dvd_ring->hold = true;
+
+}
+
+uint32_t dvd_ring_held(struct dvd_ring *dvd_ring, struct dvd_ring_slot **slot) {
+
+	uint64_t tail = atomic_load_explicit(&dvd_ring->tail, memory_order_relaxed);
+
+	*slot = &dvd_ring->slot[tail % dvd_ring->slots];
+
+	return (uint32_t)(dvd_ring->read - tail);
+
+}
+
+void dvd_ring_release(struct dvd_ring *dvd_ring) {
+
+	atomic_fetch_add_explicit(&dvd_ring->tail, 1, memory_order_release);
+
+}
+
+void dvd_ring_abort(struct dvd_ring *dvd_ring) {
+
+	atomic_store_explicit(&dvd_ring->aborted, true, memory_order_release);
+
+}
@@ -0,0 +1,136 @@
+#ifndef DVD_INFO_RING_H
+#define DVD_INFO_RING_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/types.h>
+
+#ifndef DVD_VIDEO_LB_LEN
+#define DVD_VIDEO_LB_LEN 2048
+#endif
+
+// Default number of buffers in the ring
+#define DVD_RING_BUFFERS 8
+#define DVD_RING_BUFFERS_MAX 256
+
+/**
+ * A single-producer, single-consumer ring of large block buffers, used to
+ * overlap reading from the DVD with writing to the output.
+ *
+ * One thread (the reader) fills a slot and publishes it, and another thread
+ * (the writer) drains it and hands it back. The head and tail counters are
+ * the only shared state, and each one is only ever written by one side, so
+ * no locks are needed. When a side has to wait for the other one, it backs
+ * off with a short sleep, and the time spent waiting is added up as that
+ * side's stall time.
+ *
+ * Example of usage:
+ *
+ * Reader:
+ * slot = dvd_ring_write_slot(&ring);
+ * ... fill slot->buffer, slot->bad, slot->offset, slot->blocks, slot->bad_blocks ...
+ * dvd_ring_push(&ring);
+ * ...
+ * dvd_ring_finish(&ring);
+ *
+ * Writer:
+ * while((slot = dvd_ring_read_slot(&ring)) != NULL) {
+ * 	... write slot->buffer ...
+ * 	dvd_ring_pop(&ring);
+ * }
+ */
+
+struct dvd_ring_slot {
+	unsigned char *buffer;
+	bool *bad;
+	uint16_t vts;
+	uint64_t offset;
+	uint64_t blocks;
+	uint64_t bad_blocks;
+	int source_fd;
+	off_t source_offset;
+	off_t output_offset;
+};
+
+struct dvd_ring {
+	uint32_t slots;
+	uint64_t slot_blocks;
+	struct dvd_ring_slot *slot;
+	_Atomic uint64_t head;
+	_Atomic uint64_t tail;
+	uint64_t read;
+	bool hold;
+	atomic_bool finished;
+	atomic_bool aborted;
+	uint64_t reader_stall_nsecs;
+	uint64_t writer_stall_nsecs;
+};
+
+/**
+ * Allocate the ring, each of the slots holds slot_blocks blocks.
+ *
+ * Returns false if memory can't be allocated.
+ */
+bool dvd_ring_init(struct dvd_ring *dvd_ring, uint32_t slots, uint64_t slot_blocks);
+
+void dvd_ring_free(struct dvd_ring *dvd_ring);
+
+/**
+ * Reader side: wait for an empty slot to fill. Returns NULL if the writer
+ * has aborted.
+ */
+struct dvd_ring_slot *dvd_ring_write_slot(struct dvd_ring *dvd_ring);
+
+/**
+ * Reader side: publish the slot that was last filled.
+ */
+void dvd_ring_push(struct dvd_ring *dvd_ring);
+
+/**
+ * Reader side: no more slots will be published.
+ */
+void dvd_ring_finish(struct dvd_ring *dvd_ring);
+
+/**
+ * Writer side: wait for a filled slot. Returns NULL once the reader has
+ * finished and everything has been drained.
+ */
+struct dvd_ring_slot *dvd_ring_read_slot(struct dvd_ring *dvd_ring);
+
+/**
+ * Writer side: hand the slot that was last drained back to the reader.
+ */
+void dvd_ring_pop(struct dvd_ring *dvd_ring);
+
+/**
+ * Writer side: keep slots that have been drained from going back to the
+ * reader until dvd_ring_release() is called for each one, oldest first.
+ * This is needed when the output still points at the buffers after writing
+ * them, such as with vmsplice(), which leaves the pages in a pipe until
+ * they are read from the other end.
+ *
+ * Must be set before the writer starts.
+ */
+void dvd_ring_hold(struct dvd_ring *dvd_ring);
+
+/**
+ * Writer side: number of drained slots that are being held, the oldest one
+ * is returned in slot.
+ */
+uint32_t dvd_ring_held(struct dvd_ring *dvd_ring, struct dvd_ring_slot **slot);
+
+/**
+ * Writer side: hand the oldest held slot back to the reader.
+ */
+void dvd_ring_release(struct dvd_ring *dvd_ring);
+
+/**
+ * Writer side: stop the reader, for example when the output can't be
+ * written to anymore.
+ */
+void dvd_ring_abort(struct dvd_ring *dvd_ring);
+
+#endif
@@ -0,0 +1,247 @@
+#include "dvd_scan.h"
+#ifdef DVD_SCAN_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * Functions used to find MPEG start codes in VOB sectors
+ */
+
+static dvd_scan_kernel dvd_scan_kernel_selected = NULL;
+static const char *dvd_scan_kernel_selected_name = NULL;
+
+/**
+ * Check the last few positions of a sector that a vector can't reach, one
+ * at a time
+ */
+static uint32_t dvd_scan_tail(const unsigned char *sector, uint32_t ix, uint16_t *offsets, uint32_t codes) {
+
+	for(; ix + 3 < DVD_VIDEO_LB_LEN; ix++) {
+		if(sector[ix] == 0 && sector[ix + 1] == 0 && sector[ix + 2] == 1)
+			offsets[codes++] = (uint16_t)ix;
+	}
+
+	return codes;
+
+}
+
+/**
+ * Look at the third byte of a possible start code first. If it is more than
+ * 1, none of the three positions ending there can start a start code, so
+ * skip past all of them.
+ */
+uint32_t dvd_scan_sector_portable(const unsigned char *sector, uint16_t *offsets) {
+
+	uint32_t ix = 2;
+	uint32_t codes = 0;
+
+	while(ix + 1 < DVD_VIDEO_LB_LEN) {
+
+		if(sector[ix] > 1) {
+			ix += 3;
+		} else if(sector[ix] == 1) {
+			if(sector[ix - 1] == 0 && sector[ix - 2] == 0)
+				offsets[codes++] = (uint16_t)(ix - 2);
+			ix += 3;
+		} else {
+			ix++;
+		}
+
+	}
+
+	return codes;
+
+}
+
+#ifdef DVD_SCAN_X86
+
+/**
+ * Compare 16 positions at a time, against 0, 0, 1 at offsets 0, 1 and 2.
+ * Most chunks have no 1 in them at all, so that is checked first.
+ */
+__attribute__((target("sse2")))
+uint32_t dvd_scan_sector_sse2(const unsigned char *sector, uint16_t *offsets) {
+
+	uint32_t ix = 0;
+	uint32_t codes = 0;
+	uint32_t mask = 0;
+	__m128i zero = _mm_setzero_si128();
+	__m128i one = _mm_set1_epi8(1);
+	__m128i a, b, c;
+
+	for(ix = 0; ix + 16 + 2 <= DVD_VIDEO_LB_LEN; ix += 16) {
+
+		c = _mm_loadu_si128((const __m128i *)(sector + ix + 2));
+		c = _mm_cmpeq_epi8(c, one);
+		if(_mm_movemask_epi8(c) == 0)
+			continue;
+
+		a = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(sector + ix)), zero);
+		b = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(sector + ix + 1)), zero);
+		mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_and_si128(a, b), c));
+
+		while(mask) {
+			offsets[codes++] = (uint16_t)(ix + (uint32_t)__builtin_ctz(mask));
+			mask &= mask - 1;
+		}
+
+	}
+
+	return dvd_scan_tail(sector, ix, offsets, codes);
+
+}
+
+/**
+ * The same as SSE2, 32 positions at a time
+ */
+__attribute__((target("avx2")))
+uint32_t dvd_scan_sector_avx2(const unsigned char *sector, uint16_t *offsets) {
+
+	uint32_t ix = 0;
+	uint32_t codes = 0;
+	uint32_t mask = 0;
+	__m256i zero = _mm256_setzero_si256();
+	__m256i one = _mm256_set1_epi8(1);
+	__m256i a, b, c;
+
+	for(ix = 0; ix + 32 + 2 <= DVD_VIDEO_LB_LEN; ix += 32) {
+
+		c = _mm256_loadu_si256((const __m256i *)(sector + ix + 2));
+		c = _mm256_cmpeq_epi8(c, one);
+		if(_mm256_movemask_epi8(c) == 0)
+			continue;
+
+		a = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(sector + ix)), zero);
+		b = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(sector + ix + 1)), zero);
+		mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(a, b), c));
+
+		while(mask) {
+			offsets[codes++] = (uint16_t)(ix + (uint32_t)__builtin_ctz(mask));
+			mask &= mask - 1;
+		}
+
+	}
+
+	return dvd_scan_tail(sector, ix, offsets, codes);
+
+}
+
+#endif
+
+uint32_t dvd_scan_kernels(struct dvd_scan_kernel_info *kernels, uint32_t size) {
+
+	uint32_t ix = 0;
+	struct dvd_scan_kernel_info all[] = {
+#ifdef DVD_SCAN_X86
+		{ "avx2", dvd_scan_sector_avx2, false },
+		{ "sse2", dvd_scan_sector_sse2, false },
+#endif
+		{ "portable", dvd_scan_sector_portable, true },
+	};
+	uint32_t count = sizeof(all) / sizeof(all[0]);
+
+#ifdef DVD_SCAN_X86
+	__builtin_cpu_init();
+	all[0].supported = __builtin_cpu_supports("avx2");
+	all[1].supported = __builtin_cpu_supports("sse2");
+#endif
+
+	for(ix = 0; ix < count && ix < size; ix++)
+		kernels[ix] = all[ix];
+
+	return count;
+
+}
+
+bool dvd_scan_select(const char *name) {
+
+	struct dvd_scan_kernel_info kernels[4];
+	uint32_t count = 0;
+	uint32_t ix = 0;
+
+	count = dvd_scan_kernels(kernels, 4);
+
+	// Kernels are listed fastest first
+	for(ix = 0; ix < count; ix++) {
+
+		if(!kernels[ix].supported || (name != NULL && strcmp(name, kernels[ix].name) != 0))
+			continue;
+
+		dvd_scan_kernel_selected = kernels[ix].kernel;
+		dvd_scan_kernel_selected_name = kernels[ix].name;
+
+		return true;
+
+	}
+
+	return false;
+
+}
+
+const char *dvd_scan_kernel_name(void) {
+
+	if(dvd_scan_kernel_selected == NULL)
+		dvd_scan_select(NULL);
+
+	return dvd_scan_kernel_selected_name;
+
+}
+
+uint64_t dvd_scan_blocks(const unsigned char *buffer, uint64_t first_block, uint64_t blocks, dvd_scan_callback callback, void *data) {
+
+	uint64_t block = 0;
+	uint64_t total_codes = 0;
+	uint32_t codes = 0;
+	uint16_t offsets[DVD_SCAN_MAX_CODES];
+	const unsigned char *sector = NULL;
+
+	if(dvd_scan_kernel_selected == NULL)
+		dvd_scan_select(NULL);
+
+	for(block = 0; block < blocks; block++) {
+
+		sector = buffer + block * DVD_VIDEO_LB_LEN;
+		codes = dvd_scan_kernel_selected(sector, offsets);
+		total_codes += codes;
+
+		if(callback != NULL && !callback(data, first_block + block, sector, offsets, codes))
+			break;
+
+	}
+
+	return total_codes;
+
+}
+
+bool dvd_scan_nav_pack(const unsigned char *sector, const uint16_t *offsets, uint32_t codes) {
+
+	bool pci = false;
+	uint32_t ix = 0;
+
+	if(codes < 3 || offsets[0] != 0 || sector[3] != 0xba)
+		return false;
+
+	for(ix = 1; ix < codes && offsets[ix] <= 1024; ix++) {
+		if(offsets[ix] == 38 && sector[41] == 0xbf)
+			pci = true;
+		else if(offsets[ix] == 1024 && sector[1027] == 0xbf)
+			return pci;
+	}
+
+	return false;
+
+}
+
+bool dvd_scan_nav_sector(const unsigned char *sector) {
+
+	uint32_t codes = 0;
+	uint16_t offsets[DVD_SCAN_MAX_CODES];
+
+	if(dvd_scan_kernel_selected == NULL)
+		dvd_scan_select(NULL);
+
+	codes = dvd_scan_kernel_selected(sector, offsets);
+
+	return dvd_scan_nav_pack(sector, offsets, codes);
+
+}
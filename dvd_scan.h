@@ -0,0 +1,108 @@
+#ifndef DVD_INFO_SCAN_H
+#define DVD_INFO_SCAN_H
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef DVD_VIDEO_LB_LEN
+#define DVD_VIDEO_LB_LEN 2048
+#endif
+
+// Start codes can overlap by one byte (00 00 01 00 00 01 ...), so a sector
+// can't have more than this
+#define DVD_SCAN_MAX_CODES (DVD_VIDEO_LB_LEN / 3 + 1)
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DVD_SCAN_X86
+#endif
+
+/**
+ * Find MPEG start codes (00 00 01 xx) in VOB sectors.
+ *
+ * Every pack, PES packet, and the headers in the video elementary stream
+ * begin with a start code, and anything that looks inside a VOB has to find
+ * them. Every sector is a pack of its own, so each one is scanned on its own,
+ * and a start code never runs from one sector into the next.
+ *
+ * There are a few kernels that all give the same results: a portable one
+ * that skips ahead three bytes whenever it can, and SSE2 and AVX2 ones that
+ * check 16 or 32 positions at a time. The fastest one that the CPU supports
+ * is picked the first time a sector is scanned. See dvd_scan_bench.c to
+ * compare them on real VOBs. dvd_copy uses it to find NAV packs, for --index
+ * and to follow the units of an --angle.
+ *
+ * Example:
+ * [00 00 01 ba 44 ...] [... 00 00 01 e0 07 ec ...] [... 00 00 01 b3 ...]
+ *
+ * Offsets: 0, 14, 38
+ */
+
+/**
+ * Called once for each sector, with the offsets of the start codes in it,
+ * in order. The code itself is sector[offsets[ix] + 3]. Return false to stop
+ * scanning.
+ */
+typedef bool (*dvd_scan_callback)(void *data, uint64_t block, const unsigned char *sector, const uint16_t *offsets, uint32_t codes);
+
+/**
+ * Find the start codes in one sector, and return how many there are
+ */
+typedef uint32_t (*dvd_scan_kernel)(const unsigned char *sector, uint16_t *offsets);
+
+struct dvd_scan_kernel_info {
+	const char *name;
+	dvd_scan_kernel kernel;
+	bool supported;
+};
+
+uint32_t dvd_scan_sector_portable(const unsigned char *sector, uint16_t *offsets);
+#ifdef DVD_SCAN_X86
+uint32_t dvd_scan_sector_sse2(const unsigned char *sector, uint16_t *offsets);
+uint32_t dvd_scan_sector_avx2(const unsigned char *sector, uint16_t *offsets);
+#endif
+
+/**
+ * List the kernels, and if the CPU can run them. Returns the number of
+ * kernels.
+ */
+uint32_t dvd_scan_kernels(struct dvd_scan_kernel_info *kernels, uint32_t size);
+
+/**
+ * Use a kernel by name instead of the fastest one, "portable", "sse2" or
+ * "avx2". Returns false if there is no such kernel, or the CPU doesn't
+ * support it.
+ */
+bool dvd_scan_select(const char *name);
+
+/**
+ * The name of the kernel in use
+ */
+const char *dvd_scan_kernel_name(void);
+
+/**
+ * Scan a buffer of blocks, calling the callback for each one. Returns the
+ * total number of start codes found.
+ */
+uint64_t dvd_scan_blocks(const unsigned char *buffer, uint64_t first_block, uint64_t blocks, dvd_scan_callback callback, void *data);
+
+/**
+ * A NAV pack starts with a pack header, followed by the PCI and the DSI
+ * packets (private stream 2) at fixed places in the sector. Checks the
+ * start codes found in it by the scanner.
+ *
+ * Example:
+ * [00 00 01 ba ...] [00 00 01 bb ...] [00 00 01 bf (PCI) ...] [00 00 01 bf (DSI) ...]
+ *
+ * Offsets: 0, 14, 38, 1024
+ */
+bool dvd_scan_nav_pack(const unsigned char *sector, const uint16_t *offsets, uint32_t codes);
+
+/**
+ * Scan one sector and check if it is a NAV pack
+ */
+bool dvd_scan_nav_sector(const unsigned char *sector);
+
+#endif
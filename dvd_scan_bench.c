@@ -0,0 +1,223 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "dvd_scan.h"
+
+/**
+ * Compare the start code scanners on a VOB file, or any MPEG program
+ * stream, to see how fast each one is on real data.
+ *
+ * Usage: dvd_scan_bench VTS_01_1.VOB [MBs]
+ *
+ * Up to MBs (default 256) of the file are read into memory first, so that
+ * only the scanning is timed. Each kernel scans it a few times, and the best
+ * time is kept. After that, each one scans it once more to list every start
+ * code it finds, by block and offset, and the list has to be the same as
+ * the one from the portable kernel.
+ */
+
+// Number of times to scan the data with each kernel
+#define DVD_SCAN_BENCH_PASSES 5
+
+struct dvd_scan_bench {
+	uint64_t packs;
+	uint64_t codes;
+};
+
+// Every start code found, as its block shifted left 16 bits plus its offset
+struct dvd_scan_bench_list {
+	uint64_t codes;
+	uint64_t size;
+	uint64_t *code;
+};
+
+static bool dvd_scan_bench_callback(void *data, uint64_t block, const unsigned char *sector, const uint16_t *offsets, uint32_t codes) {
+
+	struct dvd_scan_bench *dvd_scan_bench = data;
+	uint32_t ix = 0;
+
+	(void)block;
+
+	// Something has to look at the results, or the scan is all there is
+	for(ix = 0; ix < codes; ix++) {
+		if(sector[offsets[ix] + 3] == 0xba)
+			dvd_scan_bench->packs++;
+	}
+
+	dvd_scan_bench->codes += codes;
+
+	return true;
+
+}
+
+static bool dvd_scan_bench_record(void *data, uint64_t block, const unsigned char *sector, const uint16_t *offsets, uint32_t codes) {
+
+	struct dvd_scan_bench_list *list = data;
+	uint64_t *code = NULL;
+	uint32_t ix = 0;
+
+	(void)sector;
+
+	if(list->codes + codes > list->size) {
+		code = realloc(list->code, (list->size * 2 + DVD_SCAN_MAX_CODES) * sizeof(uint64_t));
+		if(code == NULL)
+			return false;
+		list->code = code;
+		list->size = list->size * 2 + DVD_SCAN_MAX_CODES;
+	}
+
+	for(ix = 0; ix < codes; ix++)
+		list->code[list->codes++] = block << 16 | offsets[ix];
+
+	return true;
+
+}
+
+/**
+ * List the start codes a kernel finds. Returns false if it ran out of
+ * memory.
+ */
+static bool dvd_scan_bench_list(struct dvd_scan_bench_list *list, const unsigned char *buffer, uint64_t blocks) {
+
+	list->codes = 0;
+
+	return dvd_scan_blocks(buffer, 0, blocks, dvd_scan_bench_record, list) == list->codes;
+
+}
+
+static double dvd_scan_bench_seconds(void) {
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+
+}
+
+int main(int argc, char **argv) {
+
+	FILE *vob_file = NULL;
+	unsigned char *buffer = NULL;
+	uint64_t max_blocks = 0;
+	uint64_t blocks = 0;
+	struct dvd_scan_kernel_info kernels[4];
+	struct dvd_scan_bench dvd_scan_bench;
+	struct dvd_scan_bench_list reference;
+	struct dvd_scan_bench_list list;
+	uint64_t code_ix = 0;
+	uint32_t count = 0;
+	uint32_t ix = 0;
+	uint32_t pass = 0;
+	double start = 0;
+	double seconds = 0;
+	double best_seconds = 0;
+	double mbs = 0;
+	int retval = 0;
+
+	if(argc < 2) {
+		printf("Usage: dvd_scan_bench <VOB filename> [MBs]\n");
+		return 1;
+	}
+
+	max_blocks = (argc > 2 ? strtoull(argv[2], NULL, 10) : 256) * 1048576 / DVD_VIDEO_LB_LEN;
+	if(max_blocks == 0) {
+		fprintf(stderr, "[dvd_scan_bench] Size must be at least 1 MB\n");
+		return 1;
+	}
+
+	vob_file = fopen(argv[1], "rb");
+	if(vob_file == NULL) {
+		fprintf(stderr, "[dvd_scan_bench] Couldn't open %s\n", argv[1]);
+		return 1;
+	}
+
+	buffer = malloc(max_blocks * DVD_VIDEO_LB_LEN);
+	if(buffer == NULL) {
+		fprintf(stderr, "[dvd_scan_bench] Couldn't allocate %" PRIu64 " blocks\n", max_blocks);
+		fclose(vob_file);
+		return 1;
+	}
+
+	blocks = fread(buffer, DVD_VIDEO_LB_LEN, max_blocks, vob_file);
+	fclose(vob_file);
+
+	if(blocks == 0) {
+		fprintf(stderr, "[dvd_scan_bench] Couldn't read any blocks from %s\n", argv[1]);
+		free(buffer);
+		return 1;
+	}
+
+	mbs = blocks * DVD_VIDEO_LB_LEN / 1048576.0;
+	printf("File: %s, Blocks: %" PRIu64 ", Size: %.0lf MBs\n", argv[1], blocks, mbs);
+
+	memset(&reference, 0, sizeof(struct dvd_scan_bench_list));
+	memset(&list, 0, sizeof(struct dvd_scan_bench_list));
+
+	// The portable kernel is the one the others are checked against
+	dvd_scan_select("portable");
+	if(!dvd_scan_bench_list(&reference, buffer, blocks)) {
+		fprintf(stderr, "[dvd_scan_bench] Couldn't allocate the list of start codes\n");
+		free(buffer);
+		free(reference.code);
+		return 1;
+	}
+
+	count = dvd_scan_kernels(kernels, 4);
+
+	for(ix = 0; ix < count; ix++) {
+
+		if(!kernels[ix].supported) {
+			printf("Kernel: %-8s not supported by this CPU\n", kernels[ix].name);
+			continue;
+		}
+
+		dvd_scan_select(kernels[ix].name);
+		best_seconds = 0;
+
+		for(pass = 0; pass < DVD_SCAN_BENCH_PASSES; pass++) {
+
+			memset(&dvd_scan_bench, 0, sizeof(struct dvd_scan_bench));
+
+			start = dvd_scan_bench_seconds();
+			dvd_scan_blocks(buffer, 0, blocks, dvd_scan_bench_callback, &dvd_scan_bench);
+			seconds = dvd_scan_bench_seconds() - start;
+
+			if(pass == 0 || seconds < best_seconds)
+				best_seconds = seconds;
+
+		}
+
+		printf("Kernel: %-8s Start codes: %" PRIu64 ", Packs: %" PRIu64 ", Time: %.4lf seconds, Speed: %.0lf MB/s\n", kernels[ix].name, dvd_scan_bench.codes, dvd_scan_bench.packs, best_seconds, best_seconds > 0 ? mbs / best_seconds : 0);
+
+		if(!dvd_scan_bench_list(&list, buffer, blocks)) {
+			fprintf(stderr, "[dvd_scan_bench] Couldn't allocate the list of start codes\n");
+			retval = 1;
+			break;
+		}
+
+		// Find the first start code that is different, or missing
+		for(code_ix = 0; code_ix < list.codes && code_ix < reference.codes && list.code[code_ix] == reference.code[code_ix]; code_ix++)
+			;
+
+		if(code_ix < list.codes || code_ix < reference.codes) {
+			fprintf(stderr, "[dvd_scan_bench] Kernel %s found %" PRIu64 " start codes, expected %" PRIu64 ", first difference at start code %" PRIu64, kernels[ix].name, list.codes, reference.codes, code_ix + 1);
+			if(code_ix < reference.codes)
+				fprintf(stderr, ", expected block %" PRIu64 " offset %" PRIu64, reference.code[code_ix] >> 16, reference.code[code_ix] & 0xffff);
+			fprintf(stderr, "\n");
+			retval = 1;
+		}
+
+	}
+
+	free(buffer);
+	free(reference.code);
+	free(list.code);
+
+	return retval;
+
+}
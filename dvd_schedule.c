@@ -0,0 +1,79 @@
+#include "dvd_schedule.h"
+
+/**
+ * Functions used to plan the order of a backup
+ */
+
+void dvd_schedule_init(struct dvd_schedule *dvd_schedule, struct dvd_layout *dvd_layout) {
+
+	dvd_schedule->files = 0;
+	dvd_schedule->dvd_layout = dvd_layout;
+	dvd_schedule->physical = dvd_layout != NULL;
+
+}
+
+void dvd_schedule_filename(char *filename, size_t size, uint8_t type, uint16_t vts) {
+
+	const char *extension = type == DVD_SCHEDULE_IFO ? "IFO" : type == DVD_SCHEDULE_BUP ? "BUP" : "VOB";
+
+	// Title sets only go up to 99, which keeps the name in 12 characters
+	if(vts == 0)
+		snprintf(filename, size, "VIDEO_TS.%s", extension);
+	else
+		snprintf(filename, size, "VTS_%02" PRIu8 "_%i.%s", (uint8_t)(vts % DVD_MAX_VTS_IFOS), type == DVD_SCHEDULE_TITLE_VOBS ? 1 : 0, extension);
+
+}
+
+void dvd_schedule_add(struct dvd_schedule *dvd_schedule, uint8_t type, uint16_t vts) {
+
+	struct dvd_schedule_file *file = NULL;
+	char filename[13];
+
+	if(dvd_schedule->files == DVD_SCHEDULE_FILES)
+		return;
+
+	file = &dvd_schedule->file[dvd_schedule->files];
+	file->type = type;
+	file->vts = vts;
+	file->lb_start = 0;
+	file->order = dvd_schedule->files;
+
+	dvd_schedule->files++;
+
+	if(!dvd_schedule->physical)
+		return;
+
+	dvd_schedule_filename(filename, sizeof(filename), type, vts);
+
+	// A file that isn't there (a title set without menus has no menu
+	// VOB) stays at 0, and is skipped when it can't be opened
+	file->lb_start = dvd_layout_lb_start(dvd_schedule->dvd_layout, filename);
+
+}
+
+static int dvd_schedule_compare(const void *a, const void *b) {
+
+	const struct dvd_schedule_file *file_a = a;
+	const struct dvd_schedule_file *file_b = b;
+
+	if(file_a->lb_start != file_b->lb_start)
+		return file_a->lb_start < file_b->lb_start ? -1 : 1;
+
+	// Empty files can share a sector with the next one
+	if(file_a->order != file_b->order)
+		return file_a->order < file_b->order ? -1 : 1;
+
+	return 0;
+
+}
+
+bool dvd_schedule_sort(struct dvd_schedule *dvd_schedule) {
+
+	if(!dvd_schedule->physical)
+		return false;
+
+	qsort(dvd_schedule->file, dvd_schedule->files, sizeof(struct dvd_schedule_file), dvd_schedule_compare);
+
+	return true;
+
+}
@@ -0,0 +1,87 @@
+#ifndef DVD_INFO_SCHEDULE_H
+#define DVD_INFO_SCHEDULE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "dvd_specs.h"
+#include "dvd_layout.h"
+
+// Kinds of files that are backed up
+#define DVD_SCHEDULE_IFO 1
+#define DVD_SCHEDULE_MENU_VOB 2
+#define DVD_SCHEDULE_TITLE_VOBS 3
+#define DVD_SCHEDULE_BUP 4
+
+// An IFO, a menu VOB, the title VOBs and a BUP for VIDEO_TS and each title set
+#define DVD_SCHEDULE_FILES (DVD_MAX_VTS_IFOS * 4)
+
+/**
+ * The order to back up the files of a disc in.
+ *
+ * Each title set is laid out on the disc as its IFO, its menu VOB, its
+ * title VOBs one after the other, and last its BUP, with the title sets
+ * following each other in order. Copying all the IFOs, then all the menus,
+ * and then the title VOBs sends the drive back and forth across the disc
+ * for every title set, and on a dual layer disc, across the layer break.
+ *
+ * Instead, the sector each file starts at is looked up in the table of the
+ * disc's files (see dvd_layout.h), and the files are copied in that order, so the disc is read
+ * from the inside out in one sweep. The title VOBs of a title set are read
+ * through libdvdread as one file, and are one entry here.
+ *
+ * Example:
+ * VIDEO_TS.IFO: 2404
+ * VIDEO_TS.VOB: 2420
+ * VIDEO_TS.BUP: 2871
+ * VTS_01_0.IFO: 2887
+ * VTS_01_0.VOB: 2918
+ * VTS_01_1.VOB: 3200
+ * VTS_01_0.BUP: 1923489
+ *
+ * A directory has no sectors, so its files are left in the order they were
+ * added.
+ */
+
+struct dvd_schedule_file {
+	uint8_t type;
+	uint16_t vts;
+	uint32_t lb_start;
+	uint16_t order;
+};
+
+struct dvd_schedule {
+	bool physical;
+	struct dvd_layout *dvd_layout;
+	uint16_t files;
+	struct dvd_schedule_file file[DVD_SCHEDULE_FILES];
+};
+
+/**
+ * Start an empty schedule. If there is a table of the files on the disc,
+ * they can be put in the order they are on it. The table is only used
+ * while adding files.
+ */
+void dvd_schedule_init(struct dvd_schedule *dvd_schedule, struct dvd_layout *dvd_layout);
+
+/**
+ * Add a file to back up, and look up where it starts on the disc.
+ */
+void dvd_schedule_add(struct dvd_schedule *dvd_schedule, uint8_t type, uint16_t vts);
+
+/**
+ * Put the files in the order they are on the disc, see above.
+ *
+ * Returns false if they are left in the order they were added.
+ */
+bool dvd_schedule_sort(struct dvd_schedule *dvd_schedule);
+
+/**
+ * Name of a file on the disc, such as "VTS_01_0.IFO"
+ */
+void dvd_schedule_filename(char *filename, size_t size, uint8_t type, uint16_t vts);
+
+#endif
@@ -0,0 +1,211 @@
+#include "dvd_source.h"
+
+/**
+ * Functions used to read VOB sectors directly from an image or directory
+ */
+
+/**
+ * Open a VOB in a directory, which can be either the VIDEO_TS directory
+ * itself or the one above it, with upper or lowercase names
+ */
+static int dvd_source_open_vob(const char *device_filename, const char *vob_filename) {
+
+	char filename[PATH_MAX];
+	char lowercase_filename[PATH_MAX];
+	size_t ix = 0;
+	int fd = -1;
+
+	memset(lowercase_filename, '\0', PATH_MAX);
+	for(ix = 0; ix < strlen(vob_filename) && ix < PATH_MAX - 1; ix++)
+		lowercase_filename[ix] = (char)tolower(vob_filename[ix]);
+
+	snprintf(filename, PATH_MAX, "%s/VIDEO_TS/%s", device_filename, vob_filename);
+	fd = open(filename, O_RDONLY);
+	if(fd != -1)
+		return fd;
+
+	snprintf(filename, PATH_MAX, "%s/%s", device_filename, vob_filename);
+	fd = open(filename, O_RDONLY);
+	if(fd != -1)
+		return fd;
+
+	snprintf(filename, PATH_MAX, "%s/video_ts/%s", device_filename, lowercase_filename);
+	fd = open(filename, O_RDONLY);
+	if(fd != -1)
+		return fd;
+
+	snprintf(filename, PATH_MAX, "%s/%s", device_filename, lowercase_filename);
+	fd = open(filename, O_RDONLY);
+
+	return fd;
+
+}
+
+bool dvd_source_open(struct dvd_source *dvd_source, dvd_reader_t *dvdread_dvd, const char *device_filename, uint16_t vts, bool menu) {
+
+	struct stat device_stat;
+	dvd_stat_t dvdread_stat;
+	char vob_filename[23];
+	char udf_filename[32];
+	uint32_t udf_filesize = 0;
+	uint32_t lb_start = 0;
+	uint64_t first_sector = 0;
+	uint16_t part = 0;
+
+	memset(dvd_source, 0, sizeof(struct dvd_source));
+	dvd_source->image_fd = -1;
+
+	if(stat(device_filename, &device_stat) == -1)
+		return false;
+
+	if(!S_ISREG(device_stat.st_mode) && !S_ISDIR(device_stat.st_mode))
+		return false;
+
+	if(dvd_vts_stat(dvdread_dvd, vts, menu, &dvdread_stat) < 0)
+		return false;
+
+	if(dvdread_stat.nr_parts < 1 || dvdread_stat.nr_parts > DVD_SOURCE_PARTS)
+		return false;
+
+	if(S_ISREG(device_stat.st_mode)) {
+		dvd_source->image = true;
+		dvd_source->image_fd = open(device_filename, O_RDONLY);
+		if(dvd_source->image_fd == -1)
+			return false;
+	}
+
+	for(part = 0; part < dvdread_stat.nr_parts; part++) {
+
+		if(vts == 0)
+			snprintf(vob_filename, sizeof(vob_filename), "VIDEO_TS.VOB");
+		else
+			snprintf(vob_filename, sizeof(vob_filename), "VTS_%02" PRIu16 "_%" PRIu16 ".VOB", vts, menu ? 0 : part + 1);
+
+		dvd_source->part[part].first_sector = first_sector;
+		dvd_source->part[part].blocks = (uint64_t)dvdread_stat.parts_size[part] / DVD_VIDEO_LB_LEN;
+		first_sector += dvd_source->part[part].blocks;
+
+		// Images have all the VOBs in one file, at the logical block
+		// where the UDF filesystem says they start
+		if(dvd_source->image) {
+			snprintf(udf_filename, sizeof(udf_filename), "/VIDEO_TS/%s", vob_filename);
+			lb_start = UDFFindFile(dvdread_dvd, udf_filename, &udf_filesize);
+			if(lb_start == 0) {
+				dvd_source_close(dvd_source);
+				return false;
+			}
+			dvd_source->part[part].fd = dvd_source->image_fd;
+			dvd_source->part[part].offset = (off_t)lb_start * DVD_VIDEO_LB_LEN;
+		} else {
+			dvd_source->part[part].fd = dvd_source_open_vob(device_filename, vob_filename);
+			dvd_source->part[part].offset = 0;
+		}
+
+		dvd_source->parts++;
+
+		if(dvd_source->part[part].fd == -1) {
+			dvd_source_close(dvd_source);
+			return false;
+		}
+
+	}
+
+	return true;
+
+}
+
+uint64_t dvd_source_map(struct dvd_source *dvd_source, uint64_t sector, uint64_t blocks, int *fd, off_t *offset) {
+
+	struct dvd_source_part *part = NULL;
+	uint16_t ix = 0;
+	uint64_t blocks_mapped = 0;
+
+	for(ix = 0; ix < dvd_source->parts; ix++) {
+
+		part = &dvd_source->part[ix];
+
+		if(sector < part->first_sector || sector >= part->first_sector + part->blocks)
+			continue;
+
+		blocks_mapped = part->first_sector + part->blocks - sector;
+		if(blocks_mapped > blocks)
+			blocks_mapped = blocks;
+
+		*fd = part->fd;
+		*offset = part->offset + (off_t)((sector - part->first_sector) * DVD_VIDEO_LB_LEN);
+
+		return blocks_mapped;
+
+	}
+
+	return 0;
+
+}
+
+bool dvd_source_pack_scrambled(const unsigned char *buffer) {
+
+	size_t pes = 0;
+
+	// Every sector is an MPEG-2 pack
+	if(buffer[0] != 0x00 || buffer[1] != 0x00 || buffer[2] != 0x01 || buffer[3] != 0xba)
+		return false;
+
+	// The PES packet follows the pack header and its stuffing
+	pes = 14 + (buffer[13] & 0x07);
+	if(buffer[pes] != 0x00 || buffer[pes + 1] != 0x00 || buffer[pes + 2] != 0x01)
+		return false;
+
+	// System headers, NAV packets and padding are never scrambled
+	if(buffer[pes + 3] == 0xbb || buffer[pes + 3] == 0xbe || buffer[pes + 3] == 0xbf)
+		return false;
+
+	return (buffer[pes + 6] & 0x30) != 0;
+
+}
+
+bool dvd_source_scrambled(struct dvd_source *dvd_source, uint64_t first_sector, uint64_t last_sector) {
+
+	unsigned char buffer[DVD_VIDEO_LB_LEN];
+	uint64_t sectors = last_sector - first_sector + 1;
+	uint64_t sample = 0;
+	uint64_t sector = 0;
+	int fd = -1;
+	off_t offset = 0;
+
+	for(sample = 0; sample < DVD_SOURCE_SAMPLES && sample < sectors; sample++) {
+
+		sector = first_sector + (sectors * sample / DVD_SOURCE_SAMPLES);
+
+		if(dvd_source_map(dvd_source, sector, 1, &fd, &offset) == 0)
+			return true;
+
+		if(pread(fd, buffer, DVD_VIDEO_LB_LEN, offset) != DVD_VIDEO_LB_LEN)
+			return true;
+
+		if(dvd_source_pack_scrambled(buffer))
+			return true;
+
+	}
+
+	return false;
+
+}
+
+void dvd_source_close(struct dvd_source *dvd_source) {
+
+	uint16_t ix = 0;
+
+	if(dvd_source->image) {
+		if(dvd_source->image_fd != -1)
+			close(dvd_source->image_fd);
+	} else {
+		for(ix = 0; ix < dvd_source->parts; ix++) {
+			if(dvd_source->part[ix].fd != -1)
+				close(dvd_source->part[ix].fd);
+		}
+	}
+
+	memset(dvd_source, 0, sizeof(struct dvd_source));
+	dvd_source->image_fd = -1;
+
+}
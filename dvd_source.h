@@ -0,0 +1,102 @@
+#ifndef DVD_INFO_SOURCE_H
+#define DVD_INFO_SOURCE_H
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/limits.h>
+#else
+#include <limits.h>
+#endif
+#include <dvdread/dvd_reader.h>
+#include <dvdread/dvd_udf.h>
+#include "dvd_vts.h"
+
+#ifndef DVD_VIDEO_LB_LEN
+#define DVD_VIDEO_LB_LEN 2048
+#endif
+
+// Title VOBs are split into at most 9 files, VTS_XX_1.VOB to VTS_XX_9.VOB
+#define DVD_SOURCE_PARTS 9
+
+// Number of sectors to look at when checking a range for CSS
+#define DVD_SOURCE_SAMPLES 64
+
+/**
+ * Direct access to the VOB files behind a DVD image or a VIDEO_TS directory
+ *
+ * libdvdread reads the VOBs in blocks, relative to the start of the title
+ * set, and decrypts them if needed. When the source is an ISO or a
+ * directory on a filesystem, and the data isn't encrypted, the same sectors
+ * can be found directly in the source files instead, so that the kernel can
+ * move (or share) them without a trip through a userspace buffer.
+ *
+ * For an ISO, the start of each VOB is looked up in the UDF filesystem, and
+ * the sectors are offsets into the image. For a directory, each VOB is its
+ * own file. Optical drives aren't mapped, since the data on a disc is
+ * usually scrambled.
+ *
+ * Sectors are only usable as is if they aren't scrambled with CSS, see
+ * dvd_source_scrambled().
+ */
+
+struct dvd_source_part {
+	int fd;
+	off_t offset;
+	uint64_t first_sector;
+	uint64_t blocks;
+};
+
+struct dvd_source {
+	bool image;
+	int image_fd;
+	uint16_t parts;
+	struct dvd_source_part part[DVD_SOURCE_PARTS];
+};
+
+/**
+ * Map the title VOBs of a title set, or the menu VOB if menu is true, to
+ * the files they are stored in.
+ *
+ * Returns false if the source isn't an image or directory, or the VOB
+ * files can't be found.
+ */
+bool dvd_source_open(struct dvd_source *dvd_source, dvd_reader_t *dvdread_dvd, const char *device_filename, uint16_t vts, bool menu);
+
+/**
+ * Find where a sector of the VOBs is stored. Returns the number of blocks,
+ * up to blocks, that follow it in the same file, and sets the file
+ * descriptor and byte offset to read them from. Returns 0 if the sector is
+ * outside of the VOBs.
+ */
+uint64_t dvd_source_map(struct dvd_source *dvd_source, uint64_t sector, uint64_t blocks, int *fd, off_t *offset);
+
+/**
+ * Check if one sector is scrambled with CSS, from the PES scrambling
+ * control bits of its MPEG pack. Sectors that aren't MPEG packs, and
+ * packets that are never scrambled (NAV packets, padding), return false.
+ */
+bool dvd_source_pack_scrambled(const unsigned char *buffer);
+
+/**
+ * Check a range of sectors for CSS. The MPEG packs in scrambled sectors
+ * have their PES scrambling control bits set. Rather than reading the
+ * whole range, DVD_SOURCE_SAMPLES sectors spread across it are checked,
+ * since a title is either scrambled throughout or not at all.
+ *
+ * Returns true if any of the sectors are scrambled, or can't be read.
+ */
+bool dvd_source_scrambled(struct dvd_source *dvd_source, uint64_t first_sector, uint64_t last_sector);
+
+void dvd_source_close(struct dvd_source *dvd_source);
+
+#endif
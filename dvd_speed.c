@@ -0,0 +1,216 @@
+#include "dvd_speed.h"
+
+/**
+ * Functions used to control the read speed of a DVD drive
+ */
+
+#ifdef __linux__
+
+// MMC commands
+#define DVD_SPEED_READ_CAPACITY 0x25
+#define DVD_SPEED_SET_STREAMING 0xb6
+
+// Restore the drive's default performance settings
+#define DVD_SPEED_RDD 0x04
+
+// Speed commands only transfer a few bytes, 5 seconds
+#define DVD_SPEED_TIMEOUT 5000
+
+static void dvd_speed_put32(unsigned char *data, uint32_t value) {
+
+	data[0] = (unsigned char)((value >> 24) & 0xff);
+	data[1] = (unsigned char)((value >> 16) & 0xff);
+	data[2] = (unsigned char)((value >> 8) & 0xff);
+	data[3] = (unsigned char)(value & 0xff);
+
+}
+
+/**
+ * The last sector of the disc, SET STREAMING applies to a range of them
+ */
+static uint32_t dvd_speed_last_sector(int fd) {
+
+	unsigned char cdb[10];
+	unsigned char data[8];
+
+	memset(cdb, 0, sizeof(cdb));
+	memset(data, 0, sizeof(data));
+	cdb[0] = DVD_SPEED_READ_CAPACITY;
+
+	if(!dvd_drive_command(fd, cdb, sizeof(cdb), data, sizeof(data), SG_DXFER_FROM_DEV, DVD_SPEED_TIMEOUT))
+		return 0xffffffff;
+
+	return (uint32_t)data[0] << 24 | (uint32_t)data[1] << 16 | (uint32_t)data[2] << 8 | (uint32_t)data[3];
+
+}
+
+/**
+ * Send SET STREAMING with a performance descriptor for the whole disc, the
+ * speed is in KB/s. A speed of 0 restores the defaults.
+ */
+static bool dvd_speed_set_streaming(int fd, uint32_t kbs) {
+
+	unsigned char cdb[12];
+	unsigned char descriptor[28];
+
+	memset(cdb, 0, sizeof(cdb));
+	memset(descriptor, 0, sizeof(descriptor));
+
+	cdb[0] = DVD_SPEED_SET_STREAMING;
+	cdb[10] = sizeof(descriptor);
+
+	if(kbs == 0)
+		descriptor[0] = DVD_SPEED_RDD;
+
+	dvd_speed_put32(descriptor + 8, dvd_speed_last_sector(fd));
+	dvd_speed_put32(descriptor + 12, kbs);
+	dvd_speed_put32(descriptor + 16, 1000);
+	dvd_speed_put32(descriptor + 20, kbs);
+	dvd_speed_put32(descriptor + 24, 1000);
+
+	return dvd_drive_command(fd, cdb, sizeof(cdb), descriptor, sizeof(descriptor), SG_DXFER_TO_DEV, DVD_SPEED_TIMEOUT);
+
+}
+
+bool dvd_speed_open(struct dvd_speed *dvd_speed, const char *device_filename) {
+
+	struct stat device_stat;
+
+	memset(dvd_speed, 0, sizeof(struct dvd_speed));
+	dvd_speed->fd = -1;
+
+	if(stat(device_filename, &device_stat) == -1 || !S_ISBLK(device_stat.st_mode))
+		return false;
+
+	dvd_speed->fd = open(device_filename, O_RDONLY | O_NONBLOCK);
+	if(dvd_speed->fd == -1)
+		return false;
+
+	return true;
+
+}
+
+bool dvd_speed_set(struct dvd_speed *dvd_speed, uint32_t speed) {
+
+	bool retval = false;
+
+	if(dvd_speed->fd == -1 || speed == 0)
+		return false;
+
+	retval = dvd_speed_set_streaming(dvd_speed->fd, speed * DVD_SPEED_KBS);
+
+	// The kernel multiplies this by the speed of a 1x CD
+	if(!retval)
+		retval = ioctl(dvd_speed->fd, CDROM_SELECT_SPEED, (speed * DVD_SPEED_KBS + DVD_SPEED_CD_KBS - 1) / DVD_SPEED_CD_KBS) == 0;
+
+	if(retval) {
+		dvd_speed->speed = speed;
+		dvd_speed->changed = true;
+	}
+
+	return retval;
+
+}
+
+void dvd_speed_close(struct dvd_speed *dvd_speed) {
+
+	if(dvd_speed->fd == -1)
+		return;
+
+	if(dvd_speed->changed && !dvd_speed_set_streaming(dvd_speed->fd, 0))
+		ioctl(dvd_speed->fd, CDROM_SELECT_SPEED, 0);
+
+	close(dvd_speed->fd);
+	dvd_speed->fd = -1;
+
+}
+
+#else
+
+bool dvd_speed_open(struct dvd_speed *dvd_speed, const char *device_filename) {
+
+	(void)device_filename;
+
+	memset(dvd_speed, 0, sizeof(struct dvd_speed));
+	dvd_speed->fd = -1;
+
+	return false;
+
+}
+
+bool dvd_speed_set(struct dvd_speed *dvd_speed, uint32_t speed) {
+
+	(void)dvd_speed;
+	(void)speed;
+
+	return false;
+
+}
+
+void dvd_speed_close(struct dvd_speed *dvd_speed) {
+
+	(void)dvd_speed;
+
+}
+
+#endif
+
+bool dvd_speed_adaptive(struct dvd_speed *dvd_speed) {
+
+	if(dvd_speed->speed == 0 && !dvd_speed_set(dvd_speed, DVD_SPEED_MAX))
+		return false;
+
+	dvd_speed->max_speed = dvd_speed->speed;
+	dvd_speed->adaptive = true;
+
+	return true;
+
+}
+
+bool dvd_speed_update(struct dvd_speed *dvd_speed, uint64_t blocks, uint64_t bad_blocks) {
+
+	uint32_t speed = dvd_speed->speed;
+
+	if(!dvd_speed->adaptive)
+		return false;
+
+	if(bad_blocks) {
+
+		dvd_speed->clean_blocks = 0;
+		dvd_speed->errors++;
+
+		if(dvd_speed->errors < DVD_SPEED_ERRORS || speed <= DVD_SPEED_MIN)
+			return false;
+
+		dvd_speed->errors = 0;
+		speed /= 2;
+		if(speed < DVD_SPEED_MIN)
+			speed = DVD_SPEED_MIN;
+
+	} else {
+
+		dvd_speed->clean_blocks += blocks;
+
+		if(dvd_speed->clean_blocks < DVD_SPEED_CLEAN_BLOCKS)
+			return false;
+
+		dvd_speed->clean_blocks = 0;
+		dvd_speed->errors = 0;
+
+		if(speed >= dvd_speed->max_speed)
+			return false;
+
+		speed *= 2;
+		if(speed > dvd_speed->max_speed)
+			speed = dvd_speed->max_speed;
+
+	}
+
+	if(!dvd_speed_set(dvd_speed, speed))
+		return false;
+
+	dvd_speed->changes++;
+
+	return true;
+
+}
@@ -0,0 +1,105 @@
+#ifndef DVD_INFO_SPEED_H
+#define DVD_INFO_SPEED_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/cdrom.h>
+#include <scsi/sg.h>
+#include "dvd_drive.h"
+#endif
+
+// DVD speed 1x is 1385 KB/s, CD speed 1x (what CDROM_SELECT_SPEED uses) is 176.4
+#define DVD_SPEED_KBS 1385
+#define DVD_SPEED_CD_KBS 177
+
+// Range that the adaptive speed moves in
+#define DVD_SPEED_MIN 1
+#define DVD_SPEED_MAX 16
+
+// Failed reads before the speed is lowered
+#define DVD_SPEED_ERRORS 3
+
+// Blocks read without errors before the speed is raised again, 64 MiB
+#define DVD_SPEED_CLEAN_BLOCKS 32768
+
+/**
+ * Set the read speed of a DVD drive, and adjust it as a copy goes.
+ *
+ * Drives pick their own speed, and that isn't always the best one. Reading
+ * worn or badly pressed discs at full speed makes a drive vibrate and fail
+ * reads it could get at a lower speed, and some drives spin down between
+ * small reads and take a while to get going again.
+ *
+ * The speed is set with MMC SET STREAMING, sent with SG_IO, which newer
+ * drives use and which also keeps them spinning at the same speed. Drives
+ * that don't support it get CDROM_SELECT_SPEED (SET CD SPEED) instead. Once
+ * the copy is done, the drive is put back to its defaults.
+ *
+ * With the adaptive speed, the speed is halved after DVD_SPEED_ERRORS reads
+ * have failed without a clean stretch in between, down to DVD_SPEED_MIN.
+ * After DVD_SPEED_CLEAN_BLOCKS blocks in a row are read without errors, it
+ * is doubled again, up to the speed it started at.
+ *
+ * Speeds are in DVD x, where 1x is 1385 KB/s. Images and directories don't
+ * have a speed, so dvd_speed_open() fails on anything that isn't a block
+ * device.
+ *
+ * Example:
+ * Speed: 16x, 3 reads failed, Speed: 8x
+ * Speed: 8x, 3 reads failed, Speed: 4x
+ * Speed: 4x, 64 MiB read, Speed: 8x
+ */
+
+struct dvd_speed {
+	int fd;
+	bool adaptive;
+	bool changed;
+	uint32_t speed;
+	uint32_t max_speed;
+	uint32_t errors;
+	uint64_t clean_blocks;
+	uint32_t changes;
+};
+
+/**
+ * Open the drive. Returns false if it isn't a drive, or can't be opened.
+ */
+bool dvd_speed_open(struct dvd_speed *dvd_speed, const char *device_filename);
+
+/**
+ * Set the read speed, in DVD x. Returns false if the drive doesn't accept
+ * it either way.
+ */
+bool dvd_speed_set(struct dvd_speed *dvd_speed, uint32_t speed);
+
+/**
+ * Start adjusting the speed to how reads go, starting at the speed that is
+ * set, or DVD_SPEED_MAX if none is. Returns false if the drive doesn't
+ * accept a speed.
+ */
+bool dvd_speed_adaptive(struct dvd_speed *dvd_speed);
+
+/**
+ * Count a read of blocks, bad_blocks of which failed, and change the speed
+ * if it is time to. Returns true if the speed changed.
+ */
+bool dvd_speed_update(struct dvd_speed *dvd_speed, uint64_t blocks, uint64_t bad_blocks);
+
+/**
+ * Put the drive back to its default speed, and close it
+ */
+void dvd_speed_close(struct dvd_speed *dvd_speed);
+
+#endif
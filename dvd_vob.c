@@ -1,4 +1,5 @@
 #include "dvd_vob.h"
+#include "dvd_vts.h"
 
 /**
  * Functions used to get information about a DVD VOB
@@ -24,12 +25,12 @@ ssize_t dvd_vob_filesize(dvd_reader_t *dvdread_dvd, uint16_t vts_number, uint16_
 	int retval = -1;
 
 	if(vob_number == 0) {
-		retval = DVDFileStat(dvdread_dvd, vts_number, DVD_READ_MENU_VOBS, &dvdread_stat);
+		retval = dvd_vts_stat(dvdread_dvd, vts_number, true, &dvdread_stat);
 		if(retval == 0)
 			vob_filesize = dvdread_stat.parts_size[0];
 	} else {
-		retval = DVDFileStat(dvdread_dvd, vts_number, DVD_READ_TITLE_VOBS, &dvdread_stat);
-		if(retval == 0)
+		retval = dvd_vts_stat(dvdread_dvd, vts_number, false, &dvdread_stat);
+		if(retval == 0 && vob_number <= dvdread_stat.nr_parts)
 			vob_filesize = dvdread_stat.parts_size[vob_number - 1];
 	}
 
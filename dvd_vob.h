@@ -29,7 +29,9 @@ uint64_t dvd_vob_blocks(dvd_reader_t *dvdread_dvd, uint16_t vts_number, uint16_t
  * Otherwise, it looks at the title VOB: VTS_XX_[1-9].VOB
  *
  * A menu vob may or may not be present on a disc, so this can safely be run to check
- * if it's zero or not.
+ * if it's zero or not. The same goes for a title VOB past the last one.
+ *
+ * The stat of the VTS is cached, see dvd_vts_stat()
  *
  */
 ssize_t dvd_vob_filesize(dvd_reader_t *dvdread_dvd, uint16_t vts_number, uint16_t vob_number);
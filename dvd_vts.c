@@ -4,20 +4,61 @@
  * Functions used to get information about a DVD VTS (a combination of VOBs)
  */
 
-ssize_t dvd_vts_blocks(dvd_reader_t *dvdread_dvd, uint16_t vts_number) {
+struct dvd_vts_stat_cache {
+	dvd_reader_t *dvdread_dvd;
+	bool statted[DVD_MAX_VTS_IFOS][2];
+	int retval[DVD_MAX_VTS_IFOS][2];
+	dvd_stat_t dvdread_stat[DVD_MAX_VTS_IFOS][2];
+};
 
-	dvd_file_t *dvdread_vts_file;
-	dvdread_vts_file = DVDOpenFile(dvdread_dvd, vts_number, DVD_READ_TITLE_VOBS);
+static struct dvd_vts_stat_cache dvd_vts_stat_cache;
 
-	if(dvdread_vts_file == 0)
-		return 0;
+int dvd_vts_stat(dvd_reader_t *dvdread_dvd, uint16_t vts_number, bool menu, dvd_stat_t *dvdread_stat) {
+
+	struct dvd_vts_stat_cache *cache = &dvd_vts_stat_cache;
+	uint8_t domain = menu ? 0 : 1;
+
+	memset(dvdread_stat, 0, sizeof(dvd_stat_t));
+
+	if(vts_number >= DVD_MAX_VTS_IFOS)
+		return -1;
+
+	if(cache->dvdread_dvd != dvdread_dvd) {
+		dvd_vts_stat_reset();
+		cache->dvdread_dvd = dvdread_dvd;
+	}
+
+	if(!cache->statted[vts_number][domain]) {
+		cache->retval[vts_number][domain] = DVDFileStat(dvdread_dvd, vts_number, menu ? DVD_READ_MENU_VOBS : DVD_READ_TITLE_VOBS, &cache->dvdread_stat[vts_number][domain]);
+		cache->statted[vts_number][domain] = true;
+	}
+
+	if(cache->retval[vts_number][domain] == 0)
+		memcpy(dvdread_stat, &cache->dvdread_stat[vts_number][domain], sizeof(dvd_stat_t));
+
+	return cache->retval[vts_number][domain];
 
+}
+
+void dvd_vts_stat_reset(void) {
+
+	memset(&dvd_vts_stat_cache, 0, sizeof(struct dvd_vts_stat_cache));
+
+}
+
+ssize_t dvd_vts_blocks(dvd_reader_t *dvdread_dvd, uint16_t vts_number) {
+
+	dvd_stat_t dvdread_stat;
 	ssize_t vts_blocks = 0;
-	vts_blocks = DVDFileSize(dvdread_vts_file);
+	int part = 0;
 
-	if(vts_blocks < 0)
+	// Same as DVDFileSize() of the title VOBs, without opening them
+	if(vts_number == 0 || dvd_vts_stat(dvdread_dvd, vts_number, false, &dvdread_stat) < 0)
 		return 0;
 
+	for(part = 0; part < dvdread_stat.nr_parts; part++)
+		vts_blocks += (ssize_t)(dvdread_stat.parts_size[part] / DVD_VIDEO_LB_LEN);
+
 	return vts_blocks;
 
 }
@@ -54,7 +95,7 @@ int dvd_vts_vobs(dvd_reader_t *dvdread_dvd, uint16_t vts_number) {
 	dvd_stat_t dvdread_stat;
 
 	int retval = 0;
-	retval = DVDFileStat(dvdread_dvd, vts_number, DVD_READ_TITLE_VOBS, &dvdread_stat);
+	retval = dvd_vts_stat(dvdread_dvd, vts_number, false, &dvdread_stat);
 	if(retval < 0)
 		return 0;
 
@@ -65,7 +106,7 @@ int dvd_vts_vobs(dvd_reader_t *dvdread_dvd, uint16_t vts_number) {
 
 }
 
-struct dvd_vts dvd_vts_open(dvd_reader_t *dvdread_dvd, uint16_t vts) {
+struct dvd_vts dvd_vts_open(dvd_reader_t *dvdread_dvd, ifo_handle_t *vts_ifo, uint16_t vts) {
 
 	struct dvd_vts dvd_vts;
 
@@ -85,9 +126,6 @@ struct dvd_vts dvd_vts_open(dvd_reader_t *dvdread_dvd, uint16_t vts) {
 	if(vts == 0)
 		return dvd_vts;
 
-	ifo_handle_t *vts_ifo = NULL;
-	vts_ifo = ifoOpen(dvdread_dvd, vts);
-
 	if(vts_ifo == NULL)
 		return dvd_vts;
 
@@ -4,6 +4,7 @@
 #include <unistd.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include <math.h>
 #include <dvdread/dvd_reader.h>
 #include <dvdread/ifo_read.h>
@@ -25,6 +26,28 @@ struct dvd_vts {
 	struct dvd_vob dvd_vobs[99];
 };
 
+/**
+ * DVDFileStat() of the menu VOB or the title VOBs of a VTS
+ *
+ * libdvdread looks each file up in the filesystem every time it is asked,
+ * and the sizes of a VTS are asked for many times (once for each VOB, for
+ * the VTS as a whole, for the number of VOBs), so the stat of each VTS is
+ * done once for a disc and kept. All the dvd_vob_*() and dvd_vts_*()
+ * functions use this. The cache is for the last disc it was used on, going
+ * by its dvd_reader_t, and is not thread safe: only look up sizes from one
+ * thread.
+ *
+ * Returns 0 on success, -1 if there are no files, the same as DVDFileStat().
+ * On failure, the stat is zeroed.
+ */
+int dvd_vts_stat(dvd_reader_t *dvdread_dvd, uint16_t vts_number, bool menu, dvd_stat_t *dvdread_stat);
+
+/**
+ * Empty the stat cache. Call it when closing the disc, so that a new one
+ * opened at the same address isn't given the old sizes.
+ */
+void dvd_vts_stat_reset(void);
+
 ssize_t dvd_vts_blocks(dvd_reader_t *dvdread_dvd, uint16_t vts_number);
 
 ssize_t dvd_vts_filesize(dvd_reader_t *dvdread_dvd, uint16_t vts_number);
@@ -33,6 +56,10 @@ double dvd_vts_filesize_mbs(dvd_reader_t *dvdread_dvd, uint16_t vts_number);
 
 int dvd_vts_vobs(dvd_reader_t *dvdread_dvd, uint16_t vts_number);
 
-struct dvd_vts dvd_vts_open(dvd_reader_t *dvdread_dvd, uint16_t vts);
+/**
+ * Look at a VTS, given its IFO, to see if it is valid and how big it is.
+ * The IFO is not closed.
+ */
+struct dvd_vts dvd_vts_open(dvd_reader_t *dvdread_dvd, ifo_handle_t *vts_ifo, uint16_t vts);
 
 #endif